@@ -0,0 +1,285 @@
+#include "BallisticTable.h"
+
+BallisticTable::BallisticTable() : bt_columns(stride) {}
+
+BallisticTable::BallisticTable(std::size_t columns) : bt_columns(columns) {
+    if (columns == 0 || columns > stride) {
+        throw std::runtime_error("invalid number of ballistic table columns");
+    }
+}
+
+void BallisticTable::addRow(int distance, const std::vector<double> &params) {
+    if (params.size() != this->bt_columns) {
+        throw std::runtime_error("invalid number of ballistic parameters in table row");
+    }
+    // any change of sparse rows makes the dense grid and inverse indexes outdated
+    releaseDense();
+    this->bt_inverse.clear();
+    detachView();
+    auto it = std::lower_bound(this->bt_distances.begin(), this->bt_distances.end(), distance);
+    auto i = static_cast<std::size_t>(it - this->bt_distances.begin());
+    auto row = this->bt_rows.begin() + static_cast<std::ptrdiff_t>(i * stride);
+    // rows with repeating distances overwrite the previous ones
+    if (it == this->bt_distances.end() || *it != distance) {
+        this->bt_distances.insert(it, distance);
+        row = this->bt_rows.insert(row, stride, 0.);
+    }
+    std::copy(params.begin(), params.end(), row);
+}
+
+// replaces the whole table with already sorted rows (e.g. from the binary table cache), rows are given with full stride
+void BallisticTable::assignRows(std::span<const int> distances, std::span<const double> rows) {
+    if (rows.size() != distances.size() * stride) {
+        throw std::runtime_error("invalid number of ballistic parameters in table rows");
+    }
+    if (std::adjacent_find(distances.begin(), distances.end(), std::greater_equal<>()) != distances.end()) {
+        throw std::runtime_error("ballistic table distances are not sorted");
+    }
+    releaseDense();
+    this->bt_inverse.clear();
+    this->bt_distance_view = {};
+    this->bt_row_view = {};
+    this->bt_distances.assign(distances.begin(), distances.end());
+    this->bt_rows.assign(rows.begin(), rows.end());
+}
+
+// makes the table refer to sorted rows kept elsewhere without copying them, the rows must outlive the table
+void BallisticTable::assignView(std::span<const int> distances, std::span<const double> rows) {
+    if (rows.size() != distances.size() * stride) {
+        throw std::runtime_error("invalid number of ballistic parameters in table rows");
+    }
+    if (std::adjacent_find(distances.begin(), distances.end(), std::greater_equal<>()) != distances.end()) {
+        throw std::runtime_error("ballistic table distances are not sorted");
+    }
+    releaseDense();
+    this->bt_inverse.clear();
+    this->bt_distances.clear();
+    this->bt_rows.clear();
+    this->bt_distance_view = distances;
+    this->bt_row_view = rows;
+}
+
+// copies rows kept elsewhere into the table, so that they can be modified
+void BallisticTable::detachView() {
+    if (this->bt_distance_view.empty()) {
+        return;
+    }
+    this->bt_distances.assign(this->bt_distance_view.begin(), this->bt_distance_view.end());
+    this->bt_rows.assign(this->bt_row_view.begin(), this->bt_row_view.end());
+    this->bt_distance_view = {};
+    this->bt_row_view = {};
+}
+
+void BallisticTable::clear() {
+    this->bt_distances.clear();
+    this->bt_rows.clear();
+    this->bt_distance_view = {};
+    this->bt_row_view = {};
+    this->bt_inverse.clear();
+    releaseDense();
+}
+
+// expands the table into rows for each meter between the minimal and maximal distances,
+// so that lookups for integer distances become a single indexed load instead of an interpolation
+void BallisticTable::densify() {
+    if (this->empty()) {
+        throw std::runtime_error("ballistic table is empty");
+    }
+    std::vector<double> dense(static_cast<std::size_t>(getMaxDistance() - getMinDistance() + 1) * stride, 0.);
+    // the grid is filled through the sparse lookup, so dense and sparse modes give the same values
+    releaseDense();
+    for (int d = getMinDistance(); d <= getMaxDistance(); ++d) {
+        auto offset = static_cast<std::size_t>(d - getMinDistance()) * stride;
+        getParameters(d, std::span<double>(dense.data() + offset, stride));
+    }
+    this->bt_dense = std::move(dense);
+}
+
+void BallisticTable::releaseDense() {
+    this->bt_dense.clear();
+    this->bt_dense.shrink_to_fit();
+}
+
+bool BallisticTable::isDense() const {
+    return !this->bt_dense.empty();
+}
+
+bool BallisticTable::empty() const {
+    return getDistances().empty();
+}
+
+std::size_t BallisticTable::size() const {
+    return getDistances().size();
+}
+
+std::size_t BallisticTable::getColumns() const {
+    return this->bt_columns;
+}
+
+int BallisticTable::getMinDistance() const {
+    if (this->empty()) {
+        throw std::runtime_error("ballistic table is empty");
+    }
+    return getDistances().front();
+}
+
+int BallisticTable::getMaxDistance() const {
+    if (this->empty()) {
+        throw std::runtime_error("ballistic table is empty");
+    }
+    return getDistances().back();
+}
+
+int BallisticTable::getDistance(std::size_t i) const {
+    return getDistances()[i];
+}
+
+const double *BallisticTable::getRow(std::size_t i) const {
+    return getRows().data() + i * stride;
+}
+
+std::span<const int> BallisticTable::getDistances() const {
+    if (!this->bt_distance_view.empty()) {
+        return this->bt_distance_view;
+    }
+    return this->bt_distances;
+}
+
+std::span<const double> BallisticTable::getRows() const {
+    if (!this->bt_distance_view.empty()) {
+        return this->bt_row_view;
+    }
+    return this->bt_rows;
+}
+
+// precomputed row of the dense grid for the given distance
+const double *BallisticTable::getDenseRow(int distance) const {
+    auto distances = getDistances();
+    if (distance < distances.front() || distance > distances.back()) {
+        throw std::runtime_error("distance out of ballistic table range");
+    }
+    return this->bt_dense.data() + static_cast<std::size_t>(distance - distances.front()) * stride;
+}
+
+// index of the last row with table distance not greater than the given one
+std::size_t BallisticTable::findRow(int distance) const {
+    auto distances = getDistances();
+    if (distances.empty() || distance < distances.front() || distance > distances.back()) {
+        throw std::runtime_error("distance out of ballistic table range");
+    }
+    auto it = std::upper_bound(distances.begin(), distances.end(), distance);
+    return static_cast<std::size_t>(it - distances.begin()) - 1;
+}
+
+// parameters for the given distance, linearly interpolated between the two neighbouring rows if not present in the table
+std::vector<double> BallisticTable::getParameters(int distance) const {
+    std::vector<double> params(this->bt_columns);
+    getParameters(distance, params);
+    return params;
+}
+
+// writes parameters for the given distance into a caller-provided row without allocating, returns number of parameters written
+std::size_t BallisticTable::getParameters(int distance, std::span<double> row) const {
+    if (row.size() < this->bt_columns) {
+        throw std::runtime_error("row too small for ballistic table parameters");
+    }
+    if (isDense()) {
+        const double *dense_row = getDenseRow(distance);
+        std::copy(dense_row, dense_row + this->bt_columns, row.begin());
+        return this->bt_columns;
+    }
+    return interpolateRow(findRow(distance), distance, row);
+}
+
+// writes parameters for a distance between i-th and (i+1)-th rows, for callers which already know the row (e.g. batches)
+std::size_t BallisticTable::interpolateRow(std::size_t i, int distance, std::span<double> row) const {
+    const double *low = getRow(i);
+    int a = getDistance(i);
+    if (a == distance) {
+        std::copy(low, low + this->bt_columns, row.begin());
+        return this->bt_columns;
+    }
+    const double *high = getRow(i + 1);
+    int b = getDistance(i + 1);
+    // rows with room for the padding are interpolated at full stride, so the kernel has no scalar tail
+    std::size_t n = row.size() >= stride ? stride : this->bt_columns;
+    interpolateParameters(low, high, a, b, distance, row.data(), n);
+    return this->bt_columns;
+}
+
+// single parameter for the given distance, interpolated the same way as the whole row in getParameters()
+double BallisticTable::getParameter(int distance, ballistic_param column) const {
+    if (isDense()) {
+        return getDenseRow(distance)[column];
+    }
+    std::size_t i = findRow(distance);
+    double low = getRow(i)[column];
+    int a = getDistance(i);
+    if (a == distance) {
+        return low;
+    }
+    double high = getRow(i + 1)[column];
+    int b = getDistance(i + 1);
+    return (high - low) * (distance - a) / (b - a) + low;
+}
+
+// builds the inverse index of a column, returns false (and keeps no index) if the column is not monotonic along the
+// distance; equal values of neighbouring rows are allowed, e.g. flight time rounded to whole seconds
+bool BallisticTable::buildInverseIndex(ballistic_param column) {
+    if (column >= this->bt_columns) {
+        throw std::runtime_error("invalid ballistic table column");
+    }
+    std::erase_if(this->bt_inverse, [column](const BallisticInverseIndex& index) { return index.bi_column == column; });
+    std::size_t n = size();
+    if (n < 2) {
+        return false;
+    }
+    BallisticInverseIndex index{column, std::vector<double>(n), std::vector<int>(n)};
+    for (std::size_t i = 0; i < n; ++i) {
+        index.bi_values[i] = getRow(i)[column];
+        index.bi_distances[i] = getDistance(i);
+    }
+    // columns decreasing with the distance (e.g. aim of mortar-like fire) are stored reversed
+    if (index.bi_values.front() > index.bi_values.back()) {
+        std::reverse(index.bi_values.begin(), index.bi_values.end());
+        std::reverse(index.bi_distances.begin(), index.bi_distances.end());
+    }
+    if (!std::is_sorted(index.bi_values.begin(), index.bi_values.end())) {
+        return false;
+    }
+    this->bt_inverse.push_back(std::move(index));
+    return true;
+}
+
+bool BallisticTable::hasInverseIndex(ballistic_param column) const {
+    return findInverseIndex(column) != nullptr;
+}
+
+const BallisticInverseIndex *BallisticTable::findInverseIndex(ballistic_param column) const {
+    for (const auto& index: this->bt_inverse) {
+        if (index.bi_column == column) {
+            return &index;
+        }
+    }
+    return nullptr;
+}
+
+// distance at which the column has the given value, linearly interpolated between the two neighbouring rows,
+// NaN if the value is out of the column range; for repeating values the first of their rows in ascending order is used
+double BallisticTable::getDistanceFromParameter(double value, ballistic_param column) const {
+    const BallisticInverseIndex *index = findInverseIndex(column);
+    if (index == nullptr) {
+        throw std::runtime_error("no inverse index for the ballistic table column");
+    }
+    const auto& values = index->bi_values;
+    if (!(value >= values.front() && value <= values.back())) {
+        return std::numeric_limits<double>::quiet_NaN();
+    }
+    auto k = static_cast<std::size_t>(std::lower_bound(values.begin(), values.end(), value) - values.begin());
+    if (values[k] == value) {
+        return index->bi_distances[k];
+    }
+    double a = index->bi_distances[k - 1];
+    double b = index->bi_distances[k];
+    return (b - a) * (value - values[k - 1]) / (values[k] - values[k - 1]) + a;
+}
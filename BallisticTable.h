@@ -0,0 +1,83 @@
+#ifndef ACE_ARTILLERY1_0_BALLISTICTABLE_H
+#define ACE_ARTILLERY1_0_BALLISTICTABLE_H
+
+#include "dependencies.h"
+#include "InterpolationKernel.h"
+#include <array>
+#include <span>
+
+// number of ballistic parameters in a table row (the distance column is kept separately)
+constexpr std::size_t BALLISTIC_PARAM_COUNT = 21;
+
+// fixed-size row able to hold all parameters of a ballistic table row
+using BallisticRow = std::array<double, BALLISTIC_PARAM_COUNT>;
+
+// distance between the starts of two rows stored in a table: the parameter count rounded up to whole SIMD registers,
+// so that the interpolation kernel reads rows without a scalar tail; padding values are zero
+constexpr std::size_t BALLISTIC_ROW_STRIDE = (BALLISTIC_PARAM_COUNT + SIMD_DOUBLE_WIDTH - 1) / SIMD_DOUBLE_WIDTH * SIMD_DOUBLE_WIDTH;
+
+// columns of a ballistic table row, in the order of csv table headers (distance column excluded)
+enum ballistic_param : u_int8_t {
+    bp_aim_div,             bp_aim_mil,             bp_v,
+    bp_delta_x_mil,         bp_dev_dist,            bp_dev_h,
+    bp_dev_lat,             bp_dir_corr_deriv,      bp_dir_corr_lat_wind,
+    bp_dir_corr_long_wind,  bp_dist_corr_p,         bp_dist_corr_air_t,
+    bp_dist_corr_proj_t,    bp_dist_corr_v,         bp_dist_corr_m,
+    bp_aim_deg,             bp_imp_deg,             bp_imp_v,
+    bp_time,                bp_meteo_h,             bp_traj_h
+};
+
+// inverse index over one column of a ballistic table, for finding the distance at which the column has a given value;
+// only built for columns monotonic along the distance, so every value belongs to a single segment between two rows
+struct BallisticInverseIndex {
+    ballistic_param bi_column;                              // Indexed column
+    std::vector<double> bi_values;                          // Column values of all rows in ascending order
+    std::vector<int> bi_distances;                          // Table distances of the rows, in the order of bi_values
+};
+
+// ballistic table for a single charge type, kept as one contiguous block sorted by distance:
+// distances are stored in their own array, parameter rows are stored back to back with a fixed stride
+class BallisticTable {
+private:
+    std::size_t bt_columns;                                 // Number of parameters per row, taken from the csv table header
+    std::vector<int> bt_distances;                          // Table distances in ascending order
+    std::vector<double> bt_rows;                            // Parameter rows, i-th row starts at bt_rows[i * stride]
+    std::vector<double> bt_dense;                           // Optional precomputed rows for each meter of the table range
+    std::span<const int> bt_distance_view;                  // Distances kept outside the table (e.g. compiled-in tables)
+    std::span<const double> bt_row_view;                    // Parameter rows kept outside the table, used with bt_distance_view
+    std::vector<BallisticInverseIndex> bt_inverse;          // Inverse indexes of monotonic columns (value -> distance)
+    [[nodiscard]] const BallisticInverseIndex* findInverseIndex(ballistic_param column) const;
+    void detachView();
+public:
+    static constexpr std::size_t stride = BALLISTIC_ROW_STRIDE;
+
+    BallisticTable();
+    explicit BallisticTable(std::size_t columns);
+    void addRow(int distance, const std::vector<double>& params);
+    void assignRows(std::span<const int> distances, std::span<const double> rows);
+    void assignView(std::span<const int> distances, std::span<const double> rows);
+    void clear();
+    void densify();
+    void releaseDense();
+    [[nodiscard]] bool isDense() const;
+    [[nodiscard]] bool empty() const;
+    [[nodiscard]] std::size_t size() const;
+    [[nodiscard]] std::size_t getColumns() const;
+    [[nodiscard]] int getMinDistance() const;
+    [[nodiscard]] int getMaxDistance() const;
+    [[nodiscard]] int getDistance(std::size_t i) const;
+    [[nodiscard]] const double* getRow(std::size_t i) const;
+    [[nodiscard]] std::span<const int> getDistances() const;
+    [[nodiscard]] std::span<const double> getRows() const;
+    [[nodiscard]] const double* getDenseRow(int distance) const;
+    [[nodiscard]] std::size_t findRow(int distance) const;
+    [[nodiscard]] std::vector<double> getParameters(int distance) const;
+    std::size_t getParameters(int distance, std::span<double> row) const;
+    std::size_t interpolateRow(std::size_t i, int distance, std::span<double> row) const;
+    [[nodiscard]] double getParameter(int distance, ballistic_param column) const;
+    bool buildInverseIndex(ballistic_param column);
+    [[nodiscard]] bool hasInverseIndex(ballistic_param column) const;
+    [[nodiscard]] double getDistanceFromParameter(double value, ballistic_param column) const;
+};
+
+#endif //ACE_ARTILLERY1_0_BALLISTICTABLE_H
@@ -0,0 +1,101 @@
+#include "CoverIndex.h"
+
+// number of Mil in the full circle
+static constexpr int FULL_CIRCLE = 6000;
+
+static int normalizeMil(int mil) {
+    mil %= FULL_CIRCLE;
+    return mil < 0 ? mil + FULL_CIRCLE : mil;
+}
+
+// a direction is blocked if it lies strictly between the cover borders
+static bool isCrossed(const Cover& cover, int azimuth) {
+    int left = normalizeMil(std::get<0>(cover).toInt());
+    int right = normalizeMil(std::get<1>(cover).toInt());
+    if (left <= right) {
+        return azimuth > left && azimuth < right;
+    }
+    return azimuth > left || azimuth < right;
+}
+
+CoverIndex::CoverIndex() {
+    rebuild();
+}
+
+CoverIndex::CoverIndex(const std::vector<Cover> &covers) : ci_covers(covers) {
+    rebuild();
+}
+
+void CoverIndex::assign(const std::vector<Cover> &covers) {
+    this->ci_covers = covers;
+    rebuild();
+}
+
+void CoverIndex::add(const Cover &cover) {
+    this->ci_covers.push_back(cover);
+    rebuild();
+}
+
+void CoverIndex::clear() {
+    this->ci_covers.clear();
+    rebuild();
+}
+
+// splits the circle at every direction where the set of crossed covers may change, i.e. right after a left border
+// and at a right border (borders themselves are not blocked), and collects the covers of each segment
+void CoverIndex::rebuild() {
+    this->ci_segments = {0};
+    for (const auto &cover: this->ci_covers) {
+        this->ci_segments.push_back(normalizeMil(std::get<0>(cover).toInt() + 1));
+        this->ci_segments.push_back(normalizeMil(std::get<1>(cover).toInt()));
+    }
+    std::sort(this->ci_segments.begin(), this->ci_segments.end());
+    this->ci_segments.erase(std::unique(this->ci_segments.begin(), this->ci_segments.end()), this->ci_segments.end());
+    this->ci_offsets.assign(1, 0);
+    this->ci_segment_covers.clear();
+    for (int start: this->ci_segments) {
+        for (std::size_t i = 0; i < this->ci_covers.size(); ++i) {
+            if (isCrossed(this->ci_covers[i], start)) {
+                this->ci_segment_covers.push_back(i);
+            }
+        }
+        this->ci_offsets.push_back(this->ci_segment_covers.size());
+    }
+}
+
+std::size_t CoverIndex::findSegment(const Mil &azimuth) const {
+    int a = normalizeMil(azimuth.toInt());
+    auto it = std::upper_bound(this->ci_segments.begin(), this->ci_segments.end(), a);
+    return static_cast<std::size_t>(it - this->ci_segments.begin()) - 1;
+}
+
+bool CoverIndex::empty() const {
+    return this->ci_covers.empty();
+}
+
+std::size_t CoverIndex::size() const {
+    return this->ci_covers.size();
+}
+
+const Cover &CoverIndex::operator[](std::size_t i) const {
+    return this->ci_covers[i];
+}
+
+const std::vector<Cover> &CoverIndex::getCovers() const {
+    return this->ci_covers;
+}
+
+// index of the first added cover crossed by the direction, -1 if the direction is free
+int CoverIndex::find(const Mil &azimuth) const {
+    std::size_t s = findSegment(azimuth);
+    if (this->ci_offsets[s] == this->ci_offsets[s + 1]) {
+        return -1;
+    }
+    return static_cast<int>(this->ci_segment_covers[this->ci_offsets[s]]);
+}
+
+// indices of all covers crossed by the direction, in order of addition
+std::span<const std::size_t> CoverIndex::findAll(const Mil &azimuth) const {
+    std::size_t s = findSegment(azimuth);
+    return {this->ci_segment_covers.data() + this->ci_offsets[s], this->ci_offsets[s + 1] - this->ci_offsets[s]};
+}
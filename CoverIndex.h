@@ -0,0 +1,36 @@
+#ifndef ACE_ARTILLERY1_0_COVERINDEX_H
+#define ACE_ARTILLERY1_0_COVERINDEX_H
+
+#include "dependencies.h"
+#include <span>
+
+// terrain cover or obstacle: left and right azimuth borders, distance and height
+using Cover = std::tuple<Mil,Mil,int,int>;
+
+// index of gun covers over the full circle (0-6000 Mil) for finding the covers crossed by a direction of fire:
+// the circle is split into segments at the cover borders, each segment keeps the covers it belongs to,
+// so a lookup is a binary search over segment starts; a cover whose left border is greater than the right one
+// crosses 00-00 (e.g. 59-00 to 01-00) and blocks directions on both sides of it
+class CoverIndex {
+private:
+    std::vector<Cover> ci_covers;                   // Covers in order of addition
+    std::vector<int> ci_segments;                   // Starts of circle segments in Mil, ascending, the first is 0
+    std::vector<std::size_t> ci_offsets;            // Covers of i-th segment are ci_segment_covers[ci_offsets[i]..ci_offsets[i + 1])
+    std::vector<std::size_t> ci_segment_covers;     // Indices of covers of each segment, in order of addition
+    void rebuild();
+    [[nodiscard]] std::size_t findSegment(const Mil& azimuth) const;
+public:
+    CoverIndex();
+    explicit CoverIndex(const std::vector<Cover>& covers);
+    void assign(const std::vector<Cover>& covers);
+    void add(const Cover& cover);
+    void clear();
+    [[nodiscard]] bool empty() const;
+    [[nodiscard]] std::size_t size() const;
+    [[nodiscard]] const Cover& operator[](std::size_t i) const;
+    [[nodiscard]] const std::vector<Cover>& getCovers() const;
+    [[nodiscard]] int find(const Mil& azimuth) const;
+    [[nodiscard]] std::span<const std::size_t> findAll(const Mil& azimuth) const;
+};
+
+#endif //ACE_ARTILLERY1_0_COVERINDEX_H
@@ -1,10 +1,19 @@
 #include "dependencies.h"
 #include "Data.h"
+#include "TableCache.h"
+#include "EmbeddedTables.h"
+#include <atomic>
 
 bool is_debug_mode = false;
+bool is_dense_tables_mode = false;
+bool is_embedded_tables_mode = true;
 
-std::vector<std::unordered_map<int, std::vector<double>>> ballistic_tables_map;
-std::vector<std::unordered_map<int, std::vector<double>>> distance_tables_map;
+std::vector<BallisticTable> ballistic_tables;
+std::vector<DistanceTable> distance_tables;
+
+std::vector<int> min_aim_grid;
+
+static std::atomic<unsigned int> unique_id_counter{0};
 
 std::string project_path;
 
@@ -40,6 +49,8 @@ const std::vector<std::string> distance_table_names = {
         "minimum-distance-d30-4th.csv",
 };
 
+const std::vector<ballistic_param> inverse_index_columns = {bp_aim_mil, bp_time, bp_traj_h};
+
 const std::vector<std::string> param_entry_names = {
         "param_entries_eng.txt",
         "param_entries_eng_short.txt",
@@ -80,6 +91,16 @@ Point& Point::operator=(const Point& m) = default;
 BatteryPoints::BatteryPoints(const std::vector<Point>& guns, double front, double depth, double x, double y, double h)
                             : bp_guns(guns), bp_front(front), bp_depth(depth), bp_x(x), bp_y(y), bp_h(h) {}
 
+unsigned int generateUniqueID() {
+    return unique_id_counter.fetch_add(1, std::memory_order_relaxed) + 1;
+}
+
+void reserveUniqueID(unsigned int id) {
+    unsigned int current = unique_id_counter.load(std::memory_order_relaxed);
+    while (current < id && !unique_id_counter.compare_exchange_weak(current, id, std::memory_order_relaxed)) {
+    }
+}
+
 bool isValidX(double val) {
     return (val>=SK_42_X_MIN && val<=SK_42_X_MAX);
 }
@@ -136,6 +157,22 @@ void setDebugVariable(const bool& value) {
     is_debug_mode = value;
 }
 
+void setEmbeddedTablesVariable(const bool& value) {
+    is_embedded_tables_mode = value;
+}
+
+void setDenseTablesVariable(const bool& value) {
+    is_dense_tables_mode = value;
+    // tables which are already loaded are switched immediately, the ones read later follow the mode on loading
+    for (auto& table : ballistic_tables) {
+        if (value) {
+            table.densify();
+        } else {
+            table.releaseDense();
+        }
+    }
+}
+
 std::tuple<std::vector<Point>, double, double, double> getRandomGuns(double k1, double k2, int n) {
     std::random_device rd;
     std::mt19937 gen(rd());
@@ -266,11 +303,13 @@ void printBattery(const BatteryPoints& battery) {
 
 std::vector<double> lineToDoubleVector(std::string line) {
     std::vector<double> vec;
-    while (line.find(',')!=-1) {
-        vec.push_back(std::stod(line.substr(0, line.find(','))));
-        line = line.substr(line.find(',')+1);
+    std::size_t start = 0;
+    std::size_t comma;
+    while ((comma = line.find(',', start)) != std::string::npos) {
+        vec.push_back(std::stod(line.substr(start, comma - start)));
+        start = comma + 1;
     }
-    vec.push_back(std::stod(line));
+    vec.push_back(std::stod(line.substr(start)));
     return vec;
 }
 
@@ -507,8 +546,9 @@ void readBallisticTableData() {
     if (chdir((project_path + "/tables").c_str()) != 0) {
         throw std::runtime_error("can't find table directory");
     }
+    ballistic_tables.clear();
     for (const auto &name: ballistic_table_names) {
-        std::unordered_map<int, std::vector<double>> current_map;
+        BallisticTable current_table;
         std::string line{};
         std::ifstream table(name);
         bool first = true;
@@ -517,16 +557,21 @@ void readBallisticTableData() {
         }
         while (std::getline(table, line)) {
             if(first){
+                // the number of parameters is the number of header columns except the distance column
+                current_table = BallisticTable(std::count(line.begin(), line.end(), ','));
                 first = false;
                 continue;
             }
             int dist = std::stoi(line.substr(0,line.find(',')));
             line = line.substr(line.find(',')+1);
             auto params = lineToDoubleVector(line);
-            current_map[dist] = params;
+            current_table.addRow(dist, params);
         }
         first = true;
-        ballistic_tables_map.push_back(current_map);
+        if (is_dense_tables_mode) {
+            current_table.densify();
+        }
+        ballistic_tables.push_back(current_table);
         table.close();
     }
     chdir(project_path.c_str());
@@ -536,8 +581,9 @@ void readMinDistTableData() {
     if (chdir((project_path + "/tables").c_str()) != 0) {
         throw std::runtime_error("can't find table directory");
     }
+    distance_tables.clear();
     for (const auto &name: distance_table_names) {
-        std::unordered_map<int, std::vector<double>> current_map;
+        DistanceTable current_table;
         std::string line{};
         std::ifstream table(name);
         bool first = true;
@@ -546,64 +592,143 @@ void readMinDistTableData() {
         }
         while (std::getline(table, line)) {
             if(first){
+                // one column of minimum distances for each cover height, the cover distance column excluded
+                current_table = DistanceTable(std::count(line.begin(), line.end(), ','));
                 first = false;
                 continue;
             }
             int dist = std::stoi(line.substr(0,line.find(',')));
             line = line.substr(line.find(',')+1);
             auto params = lineToDoubleVector(line);
-            current_map[dist] = params;
+            current_table.addRow(dist, params);
         }
-        distance_tables_map.push_back(current_map);
+        distance_tables.push_back(std::move(current_table));
         table.close();
     }
     chdir(project_path.c_str());
 }
 
 void readTableData() {
-    // filling the ballistic table
-    readBallisticTableData();
-    // filling the minimum distance table
-    readMinDistTableData();
+    bool loaded = false;
+    // tables compiled into the executable need neither csv files nor the binary cache
+    if (is_embedded_tables_mode && hasEmbeddedTables()) {
+        readEmbeddedTableData();
+        loaded = true;
+    }
+    // the binary cache is loaded if it is present and up to date with the csv tables
+    if (!loaded) {
+        loaded = readTableCache(project_path + "/tables");
+    }
+    if (loaded) {
+        if (is_dense_tables_mode) {
+            setDenseTablesVariable(true);
+        }
+    } else {
+        // filling the ballistic table
+        readBallisticTableData();
+        // filling the minimum distance table
+        readMinDistTableData();
+        // rebuilding the cache for the next start, a read-only tables directory only means parsing csv files every time
+        try {
+            writeTableCache(project_path + "/tables");
+        } catch (const std::exception& e) {
+            if (is_debug_mode) std::cout << e.what() << "\n";
+        }
+    }
+    buildInverseIndexes();
+    // calculating all cells takes longer than loading the tables, while only the covers of the guns are ever looked up
+    resetMinAimGrid();
 }
 
-std::vector<double> calculateParameters(int a, const std::vector<double>& a_val, int b, const std::vector<double>& b_val, int c) {
-    std::vector<double> c_val = {};
-    for (int i = 0; i < a_val.size(); ++i) {
-        c_val.push_back((b_val[i] - a_val[i]) * (c - a) / (b - a) + a_val[i]);
+// cell of min_aim_grid for the cover distance and height, which must be in the ranges of minimum distance tables
+static std::size_t minAimGridOffset(int cover_d, int cover_h) {
+    auto cell = static_cast<std::size_t>(cover_d - COVER_D_MIN) * (COVER_H_MAX - COVER_H_MIN + 1) +
+                static_cast<std::size_t>(cover_h - COVER_H_MIN);
+    return cell * MIN_DISTANCE_TABLE_COUNT;
+}
+
+void resetMinAimGrid() {
+    min_aim_grid.assign(minAimGridOffset(COVER_D_MAX, COVER_H_MAX) + MIN_DISTANCE_TABLE_COUNT, MIN_AIM_UNKNOWN);
+}
+
+// the cell is filled through the table lookups, so it gives exactly the same aims for integer covers; the first value
+// is written last with release order, so that a reader which sees it calculated sees the whole cell;
+// threads calculating the same cell at once write the same values; returns false if the tables are missing
+static bool fillMinAimCell(int cover_d, int cover_h) {
+    auto min_aims = calculateMinAim(cover_d, cover_h);
+    if (min_aims.size() != MIN_DISTANCE_TABLE_COUNT) {
+        return false;
+    }
+    int *cell = min_aim_grid.data() + minAimGridOffset(cover_d, cover_h);
+    for (std::size_t i = MIN_DISTANCE_TABLE_COUNT; i-- > 1;) {
+        std::atomic_ref(cell[i]).store(min_aims[i].second, std::memory_order_relaxed);
+    }
+    std::atomic_ref(cell[0]).store(min_aims[0].second, std::memory_order_release);
+    return true;
+}
+
+void buildMinAimGrid() {
+    resetMinAimGrid();
+    for (int cover_d = COVER_D_MIN; cover_d <= COVER_D_MAX; ++cover_d) {
+        for (int cover_h = COVER_H_MIN; cover_h <= COVER_H_MAX; ++cover_h) {
+            if (!fillMinAimCell(cover_d, cover_h)) {
+                throw std::runtime_error("can't build minimum aim grid: minimum distance tables are missing");
+            }
+        }
     }
+}
+
+void buildInverseIndexes() {
+    for (std::size_t i = 0; i < ballistic_tables.size(); ++i) {
+        for (ballistic_param column: inverse_index_columns) {
+            if (!ballistic_tables[i].buildInverseIndex(column) && is_debug_mode) {
+                std::cout << "no inverse index for column " << int(column) << " of " << ballistic_table_names[i]
+                          << ": values are not monotonic\n";
+            }
+        }
+    }
+}
+
+std::vector<double> calculateParameters(int a, const std::vector<double>& a_val, int b, const std::vector<double>& b_val, int c) {
+    std::vector<double> c_val(a_val.size());
+    interpolateParameters(a_val.data(), b_val.data(), a, b, c, c_val.data(), c_val.size());
     return c_val;
 }
 
 std::vector<std::pair<charge_type, int>> getMinDistances(int cover_d, int cover_h) {
-    if(distance_tables_map.empty()) {
-        throw std::runtime_error("min distance data not loaded into hash map");
+    if(distance_tables.empty()) {
+        throw std::runtime_error("min distance data not loaded");
     }
     std::vector<std::pair<charge_type, int>> min_distances;
-    for (int i = 0; i < 6; ++i) {
-        if (cover_d < 100 || cover_d > 1000 || cover_h < 5 || cover_h > 50) {
+    for (std::size_t i = 0; i < MIN_DISTANCE_TABLE_COUNT; ++i) {
+        if (cover_d < COVER_D_MIN || cover_d > COVER_D_MAX || cover_h < COVER_H_MIN || cover_h > COVER_H_MAX) {
             break;
         }
-        auto &map = distance_tables_map[i];
+        const DistanceTable &table = distance_tables[i];
         int low_d, high_d;
         int low_h, high_h;
-        if (map.find(cover_d) != map.end()) {
+        if (const double *row = table.findRow(cover_d)) {
             if (!(cover_h % 5)) {
-                min_distances.emplace_back(charge_type(2 * i), map.at(cover_d)[cover_h / 5 - 1]);
+                min_distances.emplace_back(charge_type(2 * i), row[cover_h / 5 - 1]);
             } else {
                 low_h = floor_k(cover_h, 5);
                 high_h = ceil_k(cover_h, 5);
                 auto d1 = static_cast<double>(cover_h - low_h);
                 auto d2 = static_cast<double>(high_h - low_h);
-                auto d3 = (map.at(cover_d)[high_h / 5 - 1] - map.at(cover_d)[low_h / 5 - 1]);
-                d3 = d3 * d1 / d2 + map.at(cover_d)[low_h / 5 - 1];
+                auto d3 = (row[high_h / 5 - 1] - row[low_h / 5 - 1]);
+                d3 = d3 * d1 / d2 + row[low_h / 5 - 1];
                 int dist = static_cast<int>(d3);
                 min_distances.emplace_back(charge_type(2 * i), dist);
             }
         } else {
             low_d = floor_k(cover_d, 100);
             high_d = ceil_k(cover_d, 100);
-            std::vector<double> distances = calculateParameters(low_d, map[low_d], high_d, map[high_d], cover_d);
+            const double *low_row = table.findRow(low_d), *high_row = table.findRow(high_d);
+            if (!low_row || !high_row) {
+                throw std::runtime_error("min distance table has no row for cover distance");
+            }
+            std::vector<double> distances(table.getColumns());
+            interpolateParameters(low_row, high_row, low_d, high_d, cover_d, distances.data(), distances.size());
             if(!(cover_h%5)) {
                 min_distances.emplace_back(charge_type(2*i),distances[cover_h/5-1]);
             }
@@ -641,39 +766,96 @@ std::vector<std::pair<charge_type, std::vector<double>>> getParameters(int dista
         if (distance < dist_boundaries[i].first || distance > dist_boundaries[i].second) {
             continue;
         }
-        const auto &map = ballistic_tables_map[i];
-        int low, high;
-        if (map.find(distance) != map.end()) {
-            params.emplace_back(charge_type(i), map.at(distance));
-        } else {
-            if (map.find(floor_k(distance, 100)) != map.end()) {
-                low = floor_k(distance, 100);
-            } else {
-                low = floor_k(distance, 200);
-            }
-            if (map.find(ceil_k(distance, 100)) != map.end()) {
-                high = ceil_k(distance, 100);
-            } else {
-                high = ceil_k(distance, 200);
-            }
-            if (is_debug_mode) {
-                std::cout << "low and high distances available in the current map: " << low << ", " << high << "\n";
-            }
-            params.emplace_back(charge_type(i), calculateParameters(low, map.at(low), high, map.at(high), distance));
-        }
+        params.emplace_back(charge_type(i), ballistic_tables[i].getParameters(distance));
     }
     return params;
 }
 
 std::vector<double> getParametersChargeType(int distance, charge_type charge) {
-    auto all_params = getParameters(distance);
-    for (const auto &p: all_params) {
-        if (p.first == charge) {
-            return p.second;
+    if (distance < dist_boundaries[charge].first || distance > dist_boundaries[charge].second) {
+        // must be unreachable
+        return {};
+    }
+    return ballistic_tables[charge].getParameters(distance);
+}
+
+std::size_t getParametersChargeType(int distance, charge_type charge, std::span<double> row) {
+    if (distance < dist_boundaries[charge].first || distance > dist_boundaries[charge].second) {
+        return 0;
+    }
+    return ballistic_tables[charge].getParameters(distance, row);
+}
+
+double getParameterChargeType(int distance, charge_type charge, ballistic_param column) {
+    if (distance < dist_boundaries[charge].first || distance > dist_boundaries[charge].second) {
+        return std::numeric_limits<double>::quiet_NaN();
+    }
+    return ballistic_tables[charge].getParameter(distance, column);
+}
+
+BallisticBatch::BallisticBatch() : bb_count(0), bb_slots() {
+    this->bb_slots.fill(-1);
+}
+
+bool BallisticBatch::isValid(std::size_t i, charge_type charge) const {
+    return this->bb_slots[charge] >= 0 && this->bb_valid[i * this->bb_charges.size() + this->bb_slots[charge]];
+}
+
+const double* BallisticBatch::getRow(std::size_t i, charge_type charge) const {
+    if (!isValid(i, charge)) {
+        throw std::runtime_error("no parameters in the batch for the distance and charge type");
+    }
+    return this->bb_params.data() + (i * this->bb_charges.size() + this->bb_slots[charge]) * BALLISTIC_ROW_STRIDE;
+}
+
+BallisticBatch getParametersBatch(std::span<const int> distances, u_int16_t charge_mask) {
+    BallisticBatch result;
+    getParametersBatch(distances, charge_mask, result);
+    return result;
+}
+
+void getParametersBatch(std::span<const int> distances, u_int16_t charge_mask, BallisticBatch& result) {
+    result.bb_count = distances.size();
+    result.bb_charges.clear();
+    result.bb_slots.fill(-1);
+    for (std::size_t c = 0; c < CHARGE_TYPE_COUNT; ++c) {
+        if (charge_mask & chargeMask(charge_type(c))) {
+            result.bb_slots[c] = static_cast<int>(result.bb_charges.size());
+            result.bb_charges.push_back(charge_type(c));
+        }
+    }
+    std::size_t width = result.bb_charges.size();
+    result.bb_params.assign(distances.size() * width * BALLISTIC_ROW_STRIDE, 0.);
+    result.bb_valid.assign(distances.size() * width, 0);
+
+    // indices of distances in ascending order of distance
+    std::vector<std::size_t> order(distances.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::sort(order.begin(), order.end(), [&distances](std::size_t a, std::size_t b) {
+        return distances[a] < distances[b];
+    });
+    for (std::size_t slot = 0; slot < width; ++slot) {
+        charge_type charge = result.bb_charges[slot];
+        const auto& table = ballistic_tables[charge];
+        // the row cursor only moves forward, since distances are visited in ascending order
+        std::size_t row = 0;
+        for (std::size_t i: order) {
+            int distance = distances[i];
+            if (distance < dist_boundaries[charge].first || distance > dist_boundaries[charge].second) {
+                continue;
+            }
+            std::span<double> out(result.bb_params.data() + (i * width + slot) * BALLISTIC_ROW_STRIDE, BALLISTIC_ROW_STRIDE);
+            if (table.isDense()) {
+                table.getParameters(distance, out);
+            } else {
+                while (row + 1 < table.size() && table.getDistance(row + 1) <= distance) {
+                    ++row;
+                }
+                table.interpolateRow(row, distance, out);
+            }
+            result.bb_valid[i * width + slot] = 1;
         }
     }
-    // must be unreachable
-    return {};
 }
 
 void printParameters(const std::vector<std::pair<charge_type, std::vector<double>>>& parameters) {
@@ -716,52 +898,106 @@ bool isSameButMortar(charge_type t1, charge_type t2) {
 }
 
 charge_type convertIfMortar(charge_type t) {
-    if (t == lt_full || t == lt_reduced || t == lt_1st || t == lt_2nd || t == lt_3rd || t == lt_4th) return t;
-    switch (t) {
-        case lt_full_mortar:
-            return lt_full;
-        case lt_reduced_mortar:
-            return lt_reduced;
-        case lt_1st_mortar:
-            return lt_1st;
-        case lt_2nd_mortar:
-            return lt_2nd;
-        case lt_3rd_mortar:
-            return lt_3rd;
-        case lt_4th_mortar:
-            return lt_4th;
-        default:
-            throw std::runtime_error("never should have come here");
+    if (t >= CHARGE_TYPE_COUNT) {
+        throw std::runtime_error("never should have come here");
+    }
+    return baseChargeType(t);
+}
+
+ChargeInventory::ChargeInventory() : inv_quantities() {}
+
+ChargeInventory::ChargeInventory(std::initializer_list<std::pair<const charge_type, unsigned int>> quantities) : inv_quantities() {
+    for (const auto& q: quantities) {
+        (*this)[q.first] = q.second;
+    }
+}
+
+unsigned int& ChargeInventory::operator[](charge_type charge) {
+    return this->inv_quantities[convertIfMortar(charge) / 2];
+}
+
+unsigned int ChargeInventory::operator[](charge_type charge) const {
+    return this->inv_quantities[convertIfMortar(charge) / 2];
+}
+
+// bit mask of charge types present in stock (bits of normal charge types only)
+u_int16_t ChargeInventory::getStockMask() const {
+    u_int16_t mask = 0;
+    for (std::size_t i = 0; i < BASE_CHARGE_COUNT; ++i) {
+        if (this->inv_quantities[i]) {
+            mask |= chargeMask(charge_type(2 * i));
+        }
     }
+    return mask;
 }
 
 std::vector<std::pair<charge_type, int>> getAimFromTable(int distance) {
-    auto params = getParameters(distance);
     std::vector<std::pair<charge_type, int>> aims;
-    for(const auto& p : params) {
-        aims.emplace_back(charge_type(p.first), p.second[1]);
+    for (int i = 0; i < 12; ++i) {
+        if (distance < dist_boundaries[i].first || distance > dist_boundaries[i].second) {
+            continue;
+        }
+        aims.emplace_back(charge_type(i), static_cast<int>(ballistic_tables[i].getParameter(distance, bp_aim_mil)));
     }
     return aims;
 }
 
 int getAimChargeType(int distance, charge_type charge) {
-    auto aims = getAimFromTable(distance);
-    for (const auto& p: aims) {
-        if (charge == p.first) {
-            return p.second;
+    if (distance < dist_boundaries[charge].first || distance > dist_boundaries[charge].second) {
+        return -1;
+    }
+    return static_cast<int>(ballistic_tables[charge].getParameter(distance, bp_aim_mil));
+}
+
+double getDistanceChargeType(double value, charge_type charge, ballistic_param column) {
+    const auto& table = ballistic_tables[charge];
+    if (!table.hasInverseIndex(column)) {
+        return std::numeric_limits<double>::quiet_NaN();
+    }
+    return table.getDistanceFromParameter(value, column);
+}
+
+std::vector<std::pair<charge_type, double>> getDistanceFromAim(double aim) {
+    if (ballistic_tables.empty()) {
+        throw std::runtime_error("ballistic data not loaded into hash map");
+    }
+    std::vector<std::pair<charge_type, double>> distances;
+    for (std::size_t i = 0; i < ballistic_tables.size(); ++i) {
+        double distance = getDistanceChargeType(aim, charge_type(i), bp_aim_mil);
+        if (!std::isnan(distance)) {
+            distances.emplace_back(charge_type(i), distance);
         }
     }
-    return -1;
+    return distances;
 }
 
 std::pair<int, int> getCoverDistHeight(const Mil& elev, double dist) {
-    double alpha = elev.toRadians();
-    int cover_h = static_cast<int>(dist * sin(alpha));
-    int cover_d = static_cast<int>(dist * cos(alpha));
+    int cover_h = static_cast<int>(dist * elev.sin());
+    int cover_d = static_cast<int>(dist * elev.cos());
     return {cover_d, cover_h};
 }
 
 std::vector<std::pair<charge_type, int>> getMinAim(int cover_d, int cover_h) {
+    if (min_aim_grid.empty()) {
+        return calculateMinAim(cover_d, cover_h);
+    }
+    std::vector<std::pair<charge_type, int>> min_aims;
+    if (cover_d < COVER_D_MIN || cover_d > COVER_D_MAX || cover_h < COVER_H_MIN || cover_h > COVER_H_MAX) {
+        return min_aims;
+    }
+    int *cell = min_aim_grid.data() + minAimGridOffset(cover_d, cover_h);
+    if (std::atomic_ref(cell[0]).load(std::memory_order_acquire) == MIN_AIM_UNKNOWN &&
+        !fillMinAimCell(cover_d, cover_h)) {
+        return calculateMinAim(cover_d, cover_h);
+    }
+    min_aims.reserve(MIN_DISTANCE_TABLE_COUNT);
+    for (std::size_t i = 0; i < MIN_DISTANCE_TABLE_COUNT; ++i) {
+        min_aims.emplace_back(charge_type(2 * i), std::atomic_ref(cell[i]).load(std::memory_order_relaxed));
+    }
+    return min_aims;
+}
+
+std::vector<std::pair<charge_type, int>> calculateMinAim(int cover_d, int cover_h) {
     auto min_distances = getMinDistances(cover_d, cover_h);
     std::vector<std::pair<charge_type, int>> min_aims;
     for (auto p : min_distances) {
@@ -787,21 +1023,15 @@ int getMinAimChargeType(const Mil& elev, double dist, charge_type lt) {
     return getMinAimChargeType(cover_d, cover_h, lt);
 }
 
-charge_type determineChargeType(int distance, const Mil& absolute_angle, const std::vector<std::tuple<Mil,Mil,int,int>>& covers,
-                            const std::map<charge_type, unsigned int>& charges) {
+charge_type determineChargeType(int distance, const Mil& absolute_angle, const CoverIndex& covers,
+                            const ChargeInventory& charges) {
     std::vector<std::pair<charge_type, int>> min_aims;
     std::vector<std::pair<charge_type, int>> aims = getAimFromTable(static_cast<int>(distance));
     // if the direction of fire for the considered target is intersecting with covers or mountains, the minimal aiming angles
     // will be calculated for the corresponding cover height, distance and width
-    for (auto cover: covers) {
-        auto dir_left = std::get<0>(cover);
-        auto dir_right = std::get<1>(cover);
-        auto cover_d = std::get<2>(cover);
-        auto cover_h = std::get<3>(cover);
-        if ((absolute_angle > dir_left) && (absolute_angle < dir_right)) {
-            min_aims = getMinAim(cover_d, cover_h);
-            break;
-        }
+    int cover = covers.find(absolute_angle);
+    if (cover >= 0) {
+        min_aims = getMinAim(std::get<2>(covers[cover]), std::get<3>(covers[cover]));
     }
     // if the vector for minimal aims was not filled because the direction of fire is not intersecting with covers or mountains,
     // the aims for each of the charge types will be determined as 0
@@ -827,13 +1057,12 @@ charge_type determineChargeType(int distance, const Mil& absolute_angle, const s
     if (possible_charges.empty()) {
         throw std::runtime_error("CANNOT FIRE AT THE TARGET! CHECK MINIMAL AIM TABLES");
     }
-    auto available_charges = charges;
     // traversing the charge types from lowest i.e. 4th to highest i.e. full
-    // the charge is picked if it is present in the map of available charges and
+    // the charge is picked if it is present in the inventory of available charges and
     // the distance coverage of +-800 meters is provided
     for (int i = possible_charges.size() - 1; i >= 0; --i) {
         auto pl = possible_charges[i];
-        if (available_charges[convertIfMortar(pl)] &&
+        if (charges[pl] &&
             distance + 800 <= dist_boundaries[pl].second &&
             distance - 800 >= dist_boundaries[pl].first) {
             return pl;
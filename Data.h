@@ -2,8 +2,13 @@
 #define ACE_ARTILLERY1_0_DATA_H
 
 #include "dependencies.h"
+#include "BallisticTable.h"
+#include "DistanceTable.h"
+#include "CoverIndex.h"
 
 extern bool is_debug_mode;
+extern bool is_dense_tables_mode;
+extern bool is_embedded_tables_mode;
 extern std::string project_path;
 
 // charge types - full, reduced, 1st, 2nd, 3rd, 4th
@@ -16,6 +21,41 @@ enum charge_type : u_int8_t {
     lt_4th,     lt_4th_mortar
 };
 
+// number of charge types (including mortar-like fire subdivisions)
+constexpr std::size_t CHARGE_TYPE_COUNT = 12;
+
+// bit masks of charge types for batch calculations, bit i stands for charge_type(i)
+constexpr u_int16_t ALL_CHARGES_MASK = (1u << CHARGE_TYPE_COUNT) - 1;
+constexpr u_int16_t chargeMask(charge_type charge) { return static_cast<u_int16_t>(1u << charge); }
+
+// number of charge types without mortar-like fire subdivisions, i.e. of charges kept in stock
+constexpr std::size_t BASE_CHARGE_COUNT = CHARGE_TYPE_COUNT / 2;
+
+// charge type without mortar-like fire subdivision, mortar-like fire uses the same charges as the normal one
+constexpr charge_type baseChargeType(charge_type charge) { return static_cast<charge_type>(charge & ~1u); }
+
+static_assert(baseChargeType(lt_full_mortar) == lt_full && baseChargeType(lt_4th_mortar) == lt_4th &&
+              baseChargeType(lt_2nd) == lt_2nd, "mortar-like fire charge types must follow the normal ones");
+
+// quantities of charges in stock for each charge type, mortar-like fire subdivisions share the quantity of the normal type
+class ChargeInventory {
+private:
+    std::array<unsigned int, BASE_CHARGE_COUNT> inv_quantities; // Quantity for each charge type, indexed by baseChargeType() / 2
+public:
+    ChargeInventory();
+    ChargeInventory(std::initializer_list<std::pair<const charge_type, unsigned int>> quantities);
+    unsigned int& operator[](charge_type charge);
+    unsigned int operator[](charge_type charge) const;
+    [[nodiscard]] u_int16_t getStockMask() const;
+};
+
+// ranges of cover distance and height covered by minimum distance tables, one table per charge type without mortar-like fire
+const int COVER_D_MIN = 100;
+const int COVER_D_MAX = 1000;
+const int COVER_H_MIN = 5;
+const int COVER_H_MAX = 50;
+constexpr std::size_t MIN_DISTANCE_TABLE_COUNT = CHARGE_TYPE_COUNT / 2;
+
 // coordinate boundaries for generating random points
 const double SK_42_X_MIN = 4000000.0;
 const double SK_42_X_MAX = 5000000.0;
@@ -47,11 +87,19 @@ extern std::set<std::string> target_types_eng;
 // names of military target types in russian
 extern std::set<std::string> target_types_rus;
 
-// hash tables for keeping ballistic data
-extern std::vector<std::unordered_map<int, std::vector<double>>> ballistic_tables_map;
+// ballistic tables for each charge type, in the order of charge_type enumeration
+extern std::vector<BallisticTable> ballistic_tables;
+
+// minimum distance tables for each charge type without mortar-like fire
+extern std::vector<DistanceTable> distance_tables;
+
+// minimum aims for each meter of cover distance and height in the ranges of minimum distance tables,
+// MIN_DISTANCE_TABLE_COUNT values per cell (charge types without mortar-like fire); readTableData() only allocates it,
+// a cell is calculated by the first getMinAim() for its cover and holds MIN_AIM_UNKNOWN until then
+extern std::vector<int> min_aim_grid;
 
-// hash tables for keeping minimum distance data
-extern std::vector<std::unordered_map<int, std::vector<double>>> distance_tables_map;
+// value of cells of min_aim_grid which were not calculated yet
+constexpr int MIN_AIM_UNKNOWN = std::numeric_limits<int>::min();
 
 // names of csv files containing ballistic tables
 extern const std::vector<std::string> ballistic_table_names;
@@ -59,6 +107,9 @@ extern const std::vector<std::string> ballistic_table_names;
 // names of csv files containing minimum distance tables
 extern const std::vector<std::string> distance_table_names;
 
+// columns of ballistic tables with inverse indexes (value -> distance), built by readTableData()
+extern const std::vector<ballistic_param> inverse_index_columns;
+
 // names of txt files containing ballistic parameter entries (short and long, in english and russian)
 extern const std::vector<std::string> param_entry_names;
 
@@ -67,6 +118,12 @@ extern const std::vector<std::pair<int, int>> dist_boundaries;
 
 void setDebugVariable(const bool& value);
 
+// selects whether readTableData() uses tables compiled into the executable (if there are any) instead of csv files
+void setEmbeddedTablesVariable(const bool& value);
+
+// switches ballistic tables between sparse interpolation and precomputed 1 m grids (uses about 14 MB for all charge types)
+void setDenseTablesVariable(const bool& value);
+
 struct Point {
     double pt_x;
     double pt_y;
@@ -87,11 +144,25 @@ struct BatteryPoints {
     BatteryPoints(const std::vector<Point>& guns, double front, double depth, double x, double y, double h);
 };
 
-// returns unique ID for Gun, GunTargetParameters and Target class objects
-static unsigned int generateUniqueID() {
-    static unsigned int counter = 0;
-    return ++counter;
-}
+// packed result of batch calculation of ballistic parameters: one row of BALLISTIC_PARAM_COUNT values
+// for each requested distance and each charge type from the mask, rows of a distance are kept together
+struct BallisticBatch {
+    std::size_t bb_count;                               // Number of distances in the batch
+    std::vector<charge_type> bb_charges;                // Charge types included in the batch, in ascending order
+    std::array<int, CHARGE_TYPE_COUNT> bb_slots;        // Position of each charge type in bb_charges (-1 if not included)
+    std::vector<double> bb_params;                      // Rows of parameters, (i * bb_charges.size() + slot) * BALLISTIC_ROW_STRIDE
+    std::vector<u_int8_t> bb_valid;                     // 1 if i-th distance is within table range of the charge type in the slot
+    BallisticBatch();
+    [[nodiscard]] bool isValid(std::size_t i, charge_type charge) const;
+    [[nodiscard]] const double* getRow(std::size_t i, charge_type charge) const;
+};
+
+// returns unique ID for Gun, GunTargetParameters and Target class objects, one counter for the whole process,
+// safe to call from several threads
+unsigned int generateUniqueID();
+
+// makes generateUniqueID() return only IDs greater than the given one, called after objects were loaded with their IDs
+void reserveUniqueID(unsigned int id);
 
 // reads target types from txt files and charges them into sets of strings
 void readTargetTypes();
@@ -99,9 +170,18 @@ void readTargetTypes();
 // reads data from txt files with short and long parameter names in english and russian and charges it into vector of strings
 void readParamNames();
 
-// reads data from csv files with ballistic tables and minimum distance tables and charges it into hash tables (unordered_map)
+// reads data from csv files with ballistic tables and minimum distance tables and charges it into ballistic tables and hash tables (unordered_map)
 void readTableData();
 
+// allocates min_aim_grid for the loaded tables with all cells not calculated yet
+void resetMinAimGrid();
+
+// calculates all cells of min_aim_grid from the loaded ballistic and minimum distance tables at once
+void buildMinAimGrid();
+
+// builds inverse indexes of inverse_index_columns for all loaded ballistic tables (columns which are not monotonic are skipped)
+void buildInverseIndexes();
+
 // get random point based on SK-42 coordinates
 Point getRandomPoint();
 
@@ -165,9 +245,23 @@ std::vector<double> calculateParameters(int a, const std::vector<double>& a_val,
 // parameters for each charge type based on ballistic table data
 std::vector<std::pair<charge_type, std::vector<double>>> getParameters(int distance);
 
-// parameters for a specific charge type based on ballistic table data
+// parameters for a specific charge type based on ballistic table data (only the table of that charge type is used)
 std::vector<double> getParametersChargeType(int distance, charge_type charge);
 
+// writes parameters for a specific charge type into a caller-provided row (e.g. BallisticRow) without allocating,
+// returns the number of parameters written or 0 if the distance is out of table range
+std::size_t getParametersChargeType(int distance, charge_type charge, std::span<double> row);
+
+// single parameter for a specific charge type based on ballistic table data, NaN if the distance is out of table range
+double getParameterChargeType(int distance, charge_type charge, ballistic_param column);
+
+// parameters for many distances and the charge types from the mask at once, distances are processed in ascending
+// order, so that each ballistic table is traversed once instead of being searched for every distance
+BallisticBatch getParametersBatch(std::span<const int> distances, u_int16_t charge_mask = ALL_CHARGES_MASK);
+
+// same as above, but reuses buffers of an existing batch result
+void getParametersBatch(std::span<const int> distances, u_int16_t charge_mask, BallisticBatch& result);
+
 // console output for ballistic parameters for each charge type
 void printParameters(const std::vector<std::pair<charge_type, std::vector<double>>>& parameters);
 
@@ -185,6 +279,13 @@ std::vector<std::pair<charge_type, int>> getAimFromTable(int distance);
 // calculates aim for given distance for a certain charge type
 int getAimChargeType(int distance, charge_type charge);
 
+// distance at which a column of the ballistic table has the given value for a certain charge type (inverse of the table),
+// NaN if the value is out of the table range or the column has no inverse index
+double getDistanceChargeType(double value, charge_type charge, ballistic_param column = bp_aim_mil);
+
+// calculates distance for given aim for each charge type which can fire with that aim
+std::vector<std::pair<charge_type, double>> getDistanceFromAim(double aim);
+
 // minimum distances for each charge type based on distance to the cover and cover height
 std::vector<std::pair<charge_type, int>> getMinDistances(int cover_d, int cover_h);
 
@@ -204,8 +305,13 @@ charge_type stringToChargeType(const std::string& charge);
 std::pair<int, int> getCoverDistHeight(const Mil& elev, double dist);
 
 // calculates minimum aiming angle based on distance to cover and cover height for all charge types
+// (taken from min_aim_grid, the cell is calculated on first use; may be called from several threads)
 std::vector<std::pair<charge_type, int>> getMinAim(int cover_d, int cover_h);
 
+// calculates minimum aiming angle based on distance to cover and cover height for all charge types from the tables,
+// without min_aim_grid
+std::vector<std::pair<charge_type, int>> calculateMinAim(int cover_d, int cover_h);
+
 // calculates minimum aiming angle based on cover elevation angle and distance to cover peak for all charge types
 std::vector<std::pair<charge_type, int>> getMinAim(const Mil& elev, double dist);
 
@@ -222,7 +328,7 @@ bool isSameButMortar(charge_type t1, charge_type t2);
 charge_type convertIfMortar(charge_type t);
 
 // determines the charge type for the target based on the distance, direction, presence of covers and mountains and presence of charges
-charge_type determineChargeType(int distance, const Mil& absolute_angle, const std::vector<std::tuple<Mil,Mil,int,int>>& covers,
-                            const std::map<charge_type, unsigned int>& charges);
+charge_type determineChargeType(int distance, const Mil& absolute_angle, const CoverIndex& covers,
+                            const ChargeInventory& charges);
 
 #endif
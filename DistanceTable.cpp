@@ -0,0 +1,85 @@
+#include "DistanceTable.h"
+
+DistanceTable::DistanceTable() : dt_columns(0) {}
+
+DistanceTable::DistanceTable(std::size_t columns) : dt_columns(columns) {
+    if (columns == 0) {
+        throw std::runtime_error("invalid number of minimum distance table columns");
+    }
+}
+
+void DistanceTable::addRow(int distance, const std::vector<double> &params) {
+    if (params.size() != this->dt_columns) {
+        throw std::runtime_error("invalid number of minimum distances in table row");
+    }
+    detachView();
+    auto it = std::lower_bound(this->dt_distances.begin(), this->dt_distances.end(), distance);
+    auto i = static_cast<std::size_t>(it - this->dt_distances.begin());
+    auto row = this->dt_rows.begin() + static_cast<std::ptrdiff_t>(i * this->dt_columns);
+    // rows with repeating distances overwrite the previous ones
+    if (it == this->dt_distances.end() || *it != distance) {
+        this->dt_distances.insert(it, distance);
+        row = this->dt_rows.insert(row, this->dt_columns, 0.);
+    }
+    std::copy(params.begin(), params.end(), row);
+}
+
+// makes the table refer to sorted rows kept elsewhere instead of copying them, the rows must outlive the table
+void DistanceTable::assignView(std::span<const int> distances, std::span<const double> rows) {
+    if (rows.size() != distances.size() * this->dt_columns) {
+        throw std::runtime_error("invalid number of minimum distances in table rows");
+    }
+    if (std::adjacent_find(distances.begin(), distances.end(), std::greater_equal<>()) != distances.end()) {
+        throw std::runtime_error("minimum distance table distances are not sorted");
+    }
+    this->dt_distances.clear();
+    this->dt_rows.clear();
+    this->dt_distance_view = distances;
+    this->dt_row_view = rows;
+}
+
+void DistanceTable::detachView() {
+    if (this->dt_distance_view.empty()) {
+        return;
+    }
+    this->dt_distances.assign(this->dt_distance_view.begin(), this->dt_distance_view.end());
+    this->dt_rows.assign(this->dt_row_view.begin(), this->dt_row_view.end());
+    this->dt_distance_view = {};
+    this->dt_row_view = {};
+}
+
+bool DistanceTable::empty() const {
+    return getDistances().empty();
+}
+
+std::size_t DistanceTable::size() const {
+    return getDistances().size();
+}
+
+std::size_t DistanceTable::getColumns() const {
+    return this->dt_columns;
+}
+
+std::span<const int> DistanceTable::getDistances() const {
+    if (!this->dt_distance_view.empty()) {
+        return this->dt_distance_view;
+    }
+    return this->dt_distances;
+}
+
+std::span<const double> DistanceTable::getRows() const {
+    if (!this->dt_distance_view.empty()) {
+        return this->dt_row_view;
+    }
+    return this->dt_rows;
+}
+
+// row of minimum distances for the cover distance, nullptr if the table has no row for it
+const double *DistanceTable::findRow(int distance) const {
+    auto distances = getDistances();
+    auto it = std::lower_bound(distances.begin(), distances.end(), distance);
+    if (it == distances.end() || *it != distance) {
+        return nullptr;
+    }
+    return getRows().data() + static_cast<std::size_t>(it - distances.begin()) * this->dt_columns;
+}
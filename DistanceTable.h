@@ -0,0 +1,31 @@
+#ifndef ACE_ARTILLERY1_0_DISTANCETABLE_H
+#define ACE_ARTILLERY1_0_DISTANCETABLE_H
+
+#include "dependencies.h"
+#include <span>
+
+// minimum distance table for a single charge type, kept as one contiguous block sorted by cover distance:
+// cover distances are stored in their own array, rows of minimum distances for each cover height are stored back to back;
+// as in BallisticTable, the rows may also be kept outside the table (compiled-in tables, mapped table cache)
+class DistanceTable {
+private:
+    std::size_t dt_columns;                                 // Number of cover heights per row
+    std::vector<int> dt_distances;                          // Cover distances in ascending order
+    std::vector<double> dt_rows;                            // Rows of minimum distances, i-th row starts at dt_rows[i * dt_columns]
+    std::span<const int> dt_distance_view;                  // Cover distances kept outside the table
+    std::span<const double> dt_row_view;                    // Rows kept outside the table, used with dt_distance_view
+    void detachView();
+public:
+    DistanceTable();
+    explicit DistanceTable(std::size_t columns);
+    void addRow(int distance, const std::vector<double>& params);
+    void assignView(std::span<const int> distances, std::span<const double> rows);
+    [[nodiscard]] bool empty() const;
+    [[nodiscard]] std::size_t size() const;
+    [[nodiscard]] std::size_t getColumns() const;
+    [[nodiscard]] std::span<const int> getDistances() const;
+    [[nodiscard]] std::span<const double> getRows() const;
+    [[nodiscard]] const double* findRow(int distance) const;
+};
+
+#endif //ACE_ARTILLERY1_0_DISTANCETABLE_H
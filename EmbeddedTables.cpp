@@ -0,0 +1,37 @@
+#include "EmbeddedTables.h"
+
+bool hasEmbeddedTables() {
+#ifdef ACE_EMBED_TABLES
+    return true;
+#else
+    return false;
+#endif
+}
+
+void readEmbeddedTableData() {
+#ifdef ACE_EMBED_TABLES
+    using namespace embedded_tables;
+    std::vector<BallisticTable> ballistic;
+    for (std::size_t i = 0; i + 1 < ballistic_offsets.size(); ++i) {
+        std::span<const int> distances(ballistic_distances.data() + ballistic_offsets[i],
+                                       ballistic_offsets[i + 1] - ballistic_offsets[i]);
+        std::span<const double> rows(ballistic_rows.data() + ballistic_offsets[i] * ballistic_stride,
+                                     distances.size() * ballistic_stride);
+        ballistic.emplace_back(ballistic_columns);
+        ballistic.back().assignView(distances, rows);
+    }
+    std::vector<DistanceTable> distance;
+    for (std::size_t i = 0; i + 1 < distance_offsets.size(); ++i) {
+        std::span<const int> distances(distance_keys.data() + distance_offsets[i],
+                                       distance_offsets[i + 1] - distance_offsets[i]);
+        std::span<const double> rows(distance_rows.data() + distance_offsets[i] * distance_columns,
+                                     distances.size() * distance_columns);
+        distance.emplace_back(distance_columns);
+        distance.back().assignView(distances, rows);
+    }
+    ballistic_tables = std::move(ballistic);
+    distance_tables = std::move(distance);
+#else
+    throw std::runtime_error("ballistic tables were not compiled into the executable");
+#endif
+}
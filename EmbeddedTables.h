@@ -0,0 +1,52 @@
+#ifndef ACE_ARTILLERY1_0_EMBEDDEDTABLES_H
+#define ACE_ARTILLERY1_0_EMBEDDEDTABLES_H
+
+#include "dependencies.h"
+#include "Data.h"
+
+#ifdef ACE_EMBED_TABLES
+#include "embedded_tables_data.h"
+
+// lookups straight from the tables compiled into the executable (generated by cmake/EmbedTables.cmake),
+// usable in constant expressions, e.g. for distances known at compile time
+namespace embedded_tables {
+    static_assert(ballistic_columns == BALLISTIC_PARAM_COUNT, "embedded ballistic tables have unexpected number of columns");
+    static_assert(ballistic_stride == BallisticTable::stride, "embedded ballistic rows are padded differently from BallisticTable");
+    static_assert(ballistic_offsets.size() == 13 && distance_offsets.size() == 7, "unexpected number of embedded tables");
+
+    // single parameter for a specific charge type, interpolated the same way as in BallisticTable, NaN if out of table range
+    constexpr double getParameter(int distance, charge_type charge, ballistic_param column) {
+        auto first = ballistic_distances.begin() + static_cast<std::ptrdiff_t>(ballistic_offsets[charge]);
+        auto last = ballistic_distances.begin() + static_cast<std::ptrdiff_t>(ballistic_offsets[charge + 1]);
+        if (first == last || distance < *first || distance > *(last - 1)) {
+            return std::numeric_limits<double>::quiet_NaN();
+        }
+        auto i = static_cast<std::size_t>(std::upper_bound(first, last, distance) - ballistic_distances.begin()) - 1;
+        double low = ballistic_rows[i * ballistic_stride + column];
+        int a = ballistic_distances[i];
+        if (a == distance) {
+            return low;
+        }
+        double high = ballistic_rows[(i + 1) * ballistic_stride + column];
+        int b = ballistic_distances[i + 1];
+        return (high - low) * (distance - a) / (b - a) + low;
+    }
+
+    // aim for a specific charge type, -1 if out of table range (same as getAimChargeType())
+    constexpr int getAim(int distance, charge_type charge) {
+        double aim = getParameter(distance, charge, bp_aim_mil);
+        return aim != aim ? -1 : static_cast<int>(aim);
+    }
+
+    static_assert(getAim(600, lt_full) == 1, "embedded ballistic tables are not usable in constant expressions");
+}
+#endif
+
+// true if ballistic and minimum distance tables were compiled into the executable
+bool hasEmbeddedTables();
+
+// loads ballistic and minimum distance tables from the compiled-in arrays without accessing the file system,
+// the tables refer to the compiled-in rows instead of copying them
+void readEmbeddedTableData();
+
+#endif //ACE_ARTILLERY1_0_EMBEDDEDTABLES_H
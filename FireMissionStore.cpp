@@ -0,0 +1,899 @@
+#include "FireMissionStore.h"
+#include "ThreadPool.h"
+
+FireMissionStore gun_target_parameters;
+
+// number of rows recalculated by one task of the thread pool
+static constexpr std::size_t FIRE_MISSION_GRAIN = 256;
+
+u_int64_t FireMissionStore::makeKey(unsigned int gun_id, unsigned int target_id) {
+    return (static_cast<u_int64_t>(gun_id) << 32) | target_id;
+}
+
+// binds the target to the gun and calculates the firing data, a pair which is already present is kept as it is;
+// the store keeps its own copy of the gun, shared by all rows of the gun and replaced by invalidateGun() and updateGun()
+std::size_t FireMissionStore::insert(const Gun &gun, const Target &target, charge_type charge) {
+    return insertRow(gun, target, charge, true);
+}
+
+// binds a saved pair without calculating it: the row is marked and calculated when read or on flush(), so that a pair
+// which can't be calculated at the moment (e.g. the gun stands on the target) stays bound as it was when saved
+std::size_t FireMissionStore::restore(const Gun &gun, const Target &target, charge_type charge) {
+    return insertRow(gun, target, charge, false);
+}
+
+std::size_t FireMissionStore::insertRow(const Gun &gun, const Target &target, charge_type charge, bool calculate) {
+    std::unique_lock lock(this->fm_mutex);
+    u_int64_t key = makeKey(gun.getGunID(), target.getTargetID());
+    auto it = this->fm_rows.find(key);
+    if (it != this->fm_rows.end()) {
+        return it->second;
+    }
+    auto gun_rows = findRows(this->fm_gun_rows, gun.getGunID());
+    std::shared_ptr<const Gun> gun_copy = gun_rows.empty() ? std::make_shared<const Gun>(gun)
+                                                           : this->fm_guns[gun_rows.front()];
+    // the slab takes the passed copy of the target, rows of other guns calculated for an older position are marked
+    auto target_rows = findRows(this->fm_target_rows, target.getTargetID());
+    bool target_moved = !target_rows.empty() &&
+                        TargetSlab::isMoved(this->fm_target_slab.get(this->fm_targets[target_rows.front()]), target);
+    std::size_t row = this->fm_gun_ids.size();
+    this->fm_gun_ids.push_back(gun.getGunID());
+    this->fm_target_ids.push_back(target.getTargetID());
+    this->fm_guns.push_back(std::move(gun_copy));
+    this->fm_targets.push_back(this->fm_target_slab.acquire(target));
+    this->fm_distance.push_back(0.);
+    this->fm_azimuth_abs.emplace_back();
+    this->fm_azimuth_main.emplace_back();
+    this->fm_azimuth_res.emplace_back();
+    this->fm_azimuth_night.emplace_back();
+    this->fm_azimuth_turn.push_back(0);
+    this->fm_elevation.push_back(0);
+    this->fm_level.emplace_back();
+    this->fm_charge.push_back(charge);
+    this->fm_param_count.push_back(0);
+    this->fm_ballistic.resize(this->fm_ballistic.size() + BALLISTIC_ROW_STRIDE, 0.);
+    this->fm_dirty.push_back(fd_clean);
+    if (target_moved) {
+        for (std::size_t target_row: target_rows) {
+            markRow(target_row, fd_position);
+        }
+    }
+    if (calculate) {
+        try {
+            refreshRow(row);
+        } catch (...) {
+            eraseRow(row);
+            throw;
+        }
+    } else {
+        markRow(row, fd_position);
+    }
+    this->fm_rows.emplace(key, row);
+    noteGunChange(gun.getGunID());
+    noteTargetChange(target.getTargetID());
+    this->fm_gun_rows[gun.getGunID()].push_back(row);
+    this->fm_target_rows[target.getTargetID()].push_back(row);
+    return row;
+}
+
+void FireMissionStore::replaceRow(std::vector<std::size_t> &rows, std::size_t from, std::size_t to) {
+    auto it = std::find(rows.begin(), rows.end(), from);
+    if (it != rows.end()) {
+        *it = to;
+    }
+}
+
+// removes the row by moving the last row into its place
+void FireMissionStore::eraseRow(std::size_t row) {
+    std::size_t last = this->fm_gun_ids.size() - 1;
+    if (this->fm_dirty[row] != fd_clean) {
+        --this->fm_dirty_count;
+    }
+    this->fm_target_slab.release(this->fm_targets[row]);
+    if (row != last) {
+        this->fm_gun_ids[row] = this->fm_gun_ids[last];
+        this->fm_target_ids[row] = this->fm_target_ids[last];
+        this->fm_guns[row] = std::move(this->fm_guns[last]);
+        this->fm_targets[row] = this->fm_targets[last];
+        this->fm_distance[row] = this->fm_distance[last];
+        this->fm_azimuth_abs[row] = this->fm_azimuth_abs[last];
+        this->fm_azimuth_main[row] = this->fm_azimuth_main[last];
+        this->fm_azimuth_res[row] = this->fm_azimuth_res[last];
+        this->fm_azimuth_night[row] = this->fm_azimuth_night[last];
+        this->fm_azimuth_turn[row] = this->fm_azimuth_turn[last];
+        this->fm_elevation[row] = this->fm_elevation[last];
+        this->fm_level[row] = this->fm_level[last];
+        this->fm_charge[row] = this->fm_charge[last];
+        this->fm_param_count[row] = this->fm_param_count[last];
+        this->fm_dirty[row] = this->fm_dirty[last];
+        std::copy_n(this->fm_ballistic.begin() + static_cast<std::ptrdiff_t>(last * BALLISTIC_ROW_STRIDE),
+                    BALLISTIC_ROW_STRIDE,
+                    this->fm_ballistic.begin() + static_cast<std::ptrdiff_t>(row * BALLISTIC_ROW_STRIDE));
+        this->fm_rows.at(makeKey(this->fm_gun_ids[row], this->fm_target_ids[row])) = row;
+        replaceRow(this->fm_gun_rows[this->fm_gun_ids[row]], last, row);
+        replaceRow(this->fm_target_rows[this->fm_target_ids[row]], last, row);
+    }
+    this->fm_gun_ids.pop_back();
+    this->fm_target_ids.pop_back();
+    this->fm_guns.pop_back();
+    this->fm_targets.pop_back();
+    this->fm_distance.pop_back();
+    this->fm_azimuth_abs.pop_back();
+    this->fm_azimuth_main.pop_back();
+    this->fm_azimuth_res.pop_back();
+    this->fm_azimuth_night.pop_back();
+    this->fm_azimuth_turn.pop_back();
+    this->fm_elevation.pop_back();
+    this->fm_level.pop_back();
+    this->fm_charge.pop_back();
+    this->fm_param_count.pop_back();
+    this->fm_ballistic.resize(this->fm_ballistic.size() - BALLISTIC_ROW_STRIDE);
+    this->fm_dirty.pop_back();
+}
+
+void FireMissionStore::eraseKey(unsigned int gun_id, unsigned int target_id) {
+    auto it = this->fm_rows.find(makeKey(gun_id, target_id));
+    if (it == this->fm_rows.end()) {
+        throw std::runtime_error("can't remove: target not bound to a gun");
+    }
+    std::size_t row = it->second;
+    this->fm_rows.erase(it);
+    auto remove = [row](std::unordered_map<unsigned int, std::vector<std::size_t>> &index, unsigned int id) {
+        auto &rows = index[id];
+        rows.erase(std::find(rows.begin(), rows.end(), row));
+        if (rows.empty()) {
+            index.erase(id);
+        }
+    };
+    remove(this->fm_gun_rows, gun_id);
+    remove(this->fm_target_rows, target_id);
+    eraseRow(row);
+    noteGunChange(gun_id);
+    noteTargetChange(target_id);
+}
+
+void FireMissionStore::erase(unsigned int gun_id, unsigned int target_id) {
+    std::unique_lock lock(this->fm_mutex);
+    eraseKey(gun_id, target_id);
+}
+
+void FireMissionStore::eraseGun(unsigned int gun_id) {
+    std::unique_lock lock(this->fm_mutex);
+    auto it = this->fm_gun_rows.find(gun_id);
+    if (it == this->fm_gun_rows.end()) {
+        return;
+    }
+    std::vector<unsigned int> target_ids;
+    for (std::size_t row: it->second) {
+        target_ids.push_back(this->fm_target_ids[row]);
+    }
+    for (unsigned int target_id: target_ids) {
+        eraseKey(gun_id, target_id);
+    }
+}
+
+void FireMissionStore::clear() {
+    std::unique_lock lock(this->fm_mutex);
+    this->fm_gun_ids.clear();
+    this->fm_target_ids.clear();
+    this->fm_guns.clear();
+    this->fm_targets.clear();
+    this->fm_target_slab.clear();
+    this->fm_distance.clear();
+    this->fm_azimuth_abs.clear();
+    this->fm_azimuth_main.clear();
+    this->fm_azimuth_res.clear();
+    this->fm_azimuth_night.clear();
+    this->fm_azimuth_turn.clear();
+    this->fm_elevation.clear();
+    this->fm_level.clear();
+    this->fm_charge.clear();
+    this->fm_param_count.clear();
+    this->fm_ballistic.clear();
+    this->fm_dirty.clear();
+    this->fm_dirty_count = 0;
+    this->fm_rows.clear();
+    this->fm_gun_rows.clear();
+    this->fm_target_rows.clear();
+    noteFullChange();
+}
+
+// records that the firing data of the gun changed, its missions are rebuilt in the next snapshot
+void FireMissionStore::noteGunChange(unsigned int gun_id) {
+    this->fm_changed_guns.insert(gun_id);
+    this->fm_version.fetch_add(1);
+}
+
+// records that the target was bound, dismissed or changed, it is copied again into the next snapshot
+void FireMissionStore::noteTargetChange(unsigned int target_id) {
+    this->fm_changed_targets.insert(target_id);
+    this->fm_version.fetch_add(1);
+}
+
+// the next snapshot is built from scratch instead of sharing unchanged parts of the published one
+void FireMissionStore::noteFullChange() {
+    this->fm_changed_guns.clear();
+    this->fm_changed_targets.clear();
+    this->fm_snapshot.store(nullptr);
+    this->fm_version.fetch_add(1);
+}
+
+void FireMissionStore::markRow(std::size_t row, fire_mission_dirty flag) {
+    noteGunChange(this->fm_gun_ids[row]);
+    if (this->fm_dirty[row] == fd_clean) {
+        ++this->fm_dirty_count;
+    }
+    this->fm_dirty[row] |= flag;
+}
+
+// calculates the firing data of the row from the current gun position and direction, only the row itself is written,
+// so that different rows may be calculated in parallel
+void FireMissionStore::computeRow(std::size_t row) {
+    applyGeometry(row, solveGeometry(*this->fm_guns[row], this->fm_target_slab.get(this->fm_targets[row])));
+}
+
+// fills the firing data of the row from the already solved geometry of its gun and target
+void FireMissionStore::applyGeometry(std::size_t row, const TargetGeometry &geometry) {
+    const Gun &gun = *this->fm_guns[row];
+    int turn = geometry.ge_turn;
+    auto d = static_cast<int>(geometry.ge_distance);
+    this->fm_distance[row] = geometry.ge_distance;
+    this->fm_level[row] = geometry.ge_level;
+    this->fm_elevation[row] = getAimChargeType(d, this->fm_charge[row]);
+    this->fm_azimuth_abs[row] = Mil(geometry.ge_azimuth);
+    this->fm_azimuth_turn[row] = turn;
+    this->fm_azimuth_main[row] = gun.getDirectionMain() + turn;
+    this->fm_azimuth_res[row] = gun.getDirectionRes() + turn;
+    this->fm_azimuth_night[row] = gun.getDirectionNight() + turn;
+    std::span<double> params(this->fm_ballistic.data() + row * BALLISTIC_ROW_STRIDE, BALLISTIC_ROW_STRIDE);
+    this->fm_param_count[row] = static_cast<u_int8_t>(getParametersChargeType(d, this->fm_charge[row], params));
+}
+
+// recalculates rows of a single gun, all rows must belong to the gun of the first one: every task gathers the target
+// coordinates of its rows and solves their geometry in one batch, rows are then completed one by one and marked clean;
+// a target too close to the gun fails its row the same way as computeRow(): as in forEachRow(), the failing row is
+// left marked and the rest of its range is still calculated before the range throws
+void FireMissionStore::computeGunRows(std::span<const std::size_t> rows) {
+    if (rows.empty()) {
+        return;
+    }
+    const Gun &gun = *this->fm_guns[rows.front()];
+    getThreadPool().parallelFor(rows.size(), FIRE_MISSION_GRAIN, [this, &rows, &gun](std::size_t begin, std::size_t end) {
+        std::vector<double> tg_x, tg_y, tg_h;
+        tg_x.reserve(end - begin);
+        tg_y.reserve(end - begin);
+        tg_h.reserve(end - begin);
+        for (std::size_t i = begin; i < end; ++i) {
+            const Target &target = this->fm_target_slab.get(this->fm_targets[rows[i]]);
+            tg_x.push_back(target.getTargetX());
+            tg_y.push_back(target.getTargetY());
+            tg_h.push_back(target.getTargetH());
+        }
+        GeometryBatch batch;
+        solveGeometryBatch(gun, tg_x, tg_y, tg_h, batch);
+        std::exception_ptr error;
+        for (std::size_t i = 0; i < end - begin; ++i) {
+            std::size_t row = rows[begin + i];
+            try {
+                if (!batch.gb_valid[i]) {
+                    throw std::runtime_error("distance too small");
+                }
+                applyGeometry(row, {batch.gb_distance[i], batch.gb_azimuth[i], batch.gb_turn[i], batch.gb_level[i]});
+                this->fm_dirty[row] = fd_clean;
+            } catch (...) {
+                this->fm_dirty[row] |= fd_position;
+                if (!error) {
+                    error = std::current_exception();
+                }
+            }
+        }
+        if (error) {
+            std::rethrow_exception(error);
+        }
+    });
+}
+
+// calculates the mission azimuths and the turn of the row after a change of the gun direction,
+// the absolute azimuth of the target does not depend on the direction
+void FireMissionStore::computeDirection(std::size_t row) {
+    const Gun &gun = *this->fm_guns[row];
+    int turn = calcTurn(gun.getDirectionAbs(), this->fm_azimuth_abs[row].toInt());
+    this->fm_azimuth_turn[row] = turn;
+    this->fm_azimuth_main[row] = gun.getDirectionMain() + turn;
+    this->fm_azimuth_res[row] = gun.getDirectionRes() + turn;
+    this->fm_azimuth_night[row] = gun.getDirectionNight() + turn;
+}
+
+// brings the row up to date if it was marked, the mark is only removed if the calculation succeeded;
+// as computeRow(), writes the row only and leaves fm_dirty_count to the caller
+void FireMissionStore::computeMarkedRow(std::size_t row) {
+    if (this->fm_dirty[row] & fd_position) {
+        computeRow(row);
+    } else if (this->fm_dirty[row] & fd_direction) {
+        computeDirection(row);
+    } else {
+        return;
+    }
+    std::atomic_ref(this->fm_dirty[row]).store(fd_clean, std::memory_order_release);
+}
+
+// recalculates the firing data of the row from the current gun position and direction
+void FireMissionStore::refreshRow(std::size_t row) {
+    computeRow(row);
+    if (this->fm_dirty[row] != fd_clean) {
+        this->fm_dirty[row] = fd_clean;
+        --this->fm_dirty_count;
+    }
+}
+
+// whether the row is marked; readers holding the shared lock may clear the mark at any time, the columns of a row
+// seen unmarked are complete
+bool FireMissionStore::isMarked(std::size_t row) const {
+    return std::atomic_ref(const_cast<u_int8_t &>(this->fm_dirty[row])).load(std::memory_order_acquire) != fd_clean;
+}
+
+// brings a marked row up to date under the shared lock: the row is calculated under the lock of its gun's shard,
+// so that two readers never write the same row, while readers of other guns and of unmarked rows go on
+void FireMissionStore::flushMarkedRow(std::size_t row) {
+    std::lock_guard shard_lock(this->fm_shard_mutexes[this->fm_gun_ids[row] % FIRE_MISSION_SHARD_COUNT]);
+    if (isMarked(row)) {
+        computeMarkedRow(row);
+        --this->fm_dirty_count;
+    }
+}
+
+// calls body(row) for the given rows on the shared thread pool; rows are independent, so the result does not depend
+// on the number of threads, if some rows fail the others are still calculated and the error of the first one is thrown
+void FireMissionStore::forEachRow(std::span<const std::size_t> rows, const std::function<void(std::size_t)> &body) {
+    getThreadPool().parallelFor(rows.size(), FIRE_MISSION_GRAIN, [&rows, &body](std::size_t begin, std::size_t end) {
+        // a failing row doesn't stop the rest of its range, the range throws the error of its first failing row
+        std::exception_ptr error;
+        for (std::size_t i = begin; i < end; ++i) {
+            try {
+                body(rows[i]);
+            } catch (...) {
+                if (!error) {
+                    error = std::current_exception();
+                }
+            }
+        }
+        if (error) {
+            std::rethrow_exception(error);
+        }
+    });
+}
+
+// marks are recounted after the parallel pass, rows which failed stay marked
+void FireMissionStore::recountDirty() {
+    this->fm_dirty_count = static_cast<std::size_t>(
+            std::count_if(this->fm_dirty.begin(), this->fm_dirty.end(), [](u_int8_t d) { return d != fd_clean; }));
+}
+
+void FireMissionStore::flushAll() {
+    if (!this->fm_dirty_count) {
+        return;
+    }
+    std::vector<std::size_t> rows;
+    rows.reserve(this->fm_dirty_count);
+    for (std::size_t row = 0; row < this->fm_dirty.size(); ++row) {
+        if (this->fm_dirty[row] != fd_clean) {
+            rows.push_back(row);
+        }
+    }
+    try {
+        forEachRow(rows, [this](std::size_t row) { computeMarkedRow(row); });
+    } catch (...) {
+        recountDirty();
+        throw;
+    }
+    this->fm_dirty_count = 0;
+}
+
+// brings the marked rows up to date for a snapshot; a row which can't be calculated (e.g. its gun was moved onto the
+// target) stays marked and is left out of the snapshot, so that it does not keep all other rows from being published
+void FireMissionStore::flushCalculable() {
+    if (!this->fm_dirty_count) {
+        return;
+    }
+    std::vector<std::size_t> rows;
+    rows.reserve(this->fm_dirty_count);
+    for (std::size_t row = 0; row < this->fm_dirty.size(); ++row) {
+        if (this->fm_dirty[row] != fd_clean) {
+            rows.push_back(row);
+        }
+    }
+    forEachRow(rows, [this](std::size_t row) {
+        try {
+            computeMarkedRow(row);
+        } catch (const std::runtime_error &) {
+        }
+    });
+    recountDirty();
+}
+
+// brings rows marked after changes of guns and targets up to date
+void FireMissionStore::flush() {
+    std::unique_lock lock(this->fm_mutex);
+    flushAll();
+}
+
+void FireMissionStore::updateRow(std::size_t row) {
+    std::unique_lock lock(this->fm_mutex);
+    refreshRow(row);
+    noteGunChange(this->fm_gun_ids[row]);
+}
+
+// recalculates all rows, e.g. after the ballistic tables were reloaded
+void FireMissionStore::updateAll() {
+    std::unique_lock lock(this->fm_mutex);
+    noteFullChange();
+    std::vector<std::size_t> rows(this->fm_gun_ids.size());
+    std::iota(rows.begin(), rows.end(), 0);
+    // rows of all guns are mixed here, so they are calculated one by one rather than in per-gun batches
+    try {
+        forEachRow(rows, [this](std::size_t row) {
+            computeRow(row);
+            this->fm_dirty[row] = fd_clean;
+        });
+    } catch (...) {
+        recountDirty();
+        throw;
+    }
+    this->fm_dirty_count = 0;
+}
+
+bool FireMissionStore::isDirty(std::size_t row) const {
+    std::shared_lock lock(this->fm_mutex);
+    return isMarked(row);
+}
+
+std::size_t FireMissionStore::countDirty() const {
+    std::shared_lock lock(this->fm_mutex);
+    return this->fm_dirty_count;
+}
+
+void FireMissionStore::updateGun(const Gun &gun) {
+    unsigned int gun_id = gun.getGunID();
+    std::unique_lock lock(this->fm_mutex);
+    noteGunChange(gun_id);
+    auto rows = findRows(this->fm_gun_rows, gun_id);
+    replaceGun(rows, gun);
+    auto marked = static_cast<std::size_t>(std::count_if(rows.begin(), rows.end(), [this](std::size_t row) {
+        return this->fm_dirty[row] != fd_clean;
+    }));
+    try {
+        computeGunRows(rows);
+    } catch (...) {
+        recountDirty();
+        throw;
+    }
+    this->fm_dirty_count -= marked;
+}
+
+// takes the new state of the gun and marks all its rows, they are recalculated when read or on flush();
+// called by the thread which changed the gun, so that other threads only ever read the copy kept by the store
+void FireMissionStore::invalidateGun(const Gun &gun, fire_mission_dirty flag) {
+    std::unique_lock lock(this->fm_mutex);
+    auto rows = findRows(this->fm_gun_rows, gun.getGunID());
+    replaceGun(rows, gun);
+    for (std::size_t row: rows) {
+        markRow(row, flag);
+    }
+}
+
+// replaces the copy of the gun in its rows, the previous copy may still be held by parameters objects and snapshots
+void FireMissionStore::replaceGun(std::span<const std::size_t> rows, const Gun &gun) {
+    if (rows.empty()) {
+        return;
+    }
+    auto gun_copy = std::make_shared<const Gun>(gun);
+    for (std::size_t row: rows) {
+        this->fm_guns[row] = gun_copy;
+    }
+}
+
+// takes the new state of the target into the slab, where all its rows see it; the rows are marked, and recalculated
+// when read or on flush(), only if the target moved, a new name or description is only copied into the next snapshot
+void FireMissionStore::updateTarget(const Target &target) {
+    std::unique_lock lock(this->fm_mutex);
+    auto handle = this->fm_target_slab.find(target.getTargetID());
+    if (!handle) {
+        return;
+    }
+    const Target &older = this->fm_target_slab.get(*handle);
+    if (!TargetSlab::isChanged(older, target)) {
+        return;
+    }
+    bool moved = TargetSlab::isMoved(older, target);
+    this->fm_target_slab.update(target);
+    if (moved) {
+        for (std::size_t row: findRows(this->fm_target_rows, target.getTargetID())) {
+            markRow(row, fd_position);
+        }
+    }
+    noteTargetChange(target.getTargetID());
+}
+
+std::size_t FireMissionStore::size() const {
+    std::shared_lock lock(this->fm_mutex);
+    return this->fm_gun_ids.size();
+}
+
+bool FireMissionStore::empty() const {
+    std::shared_lock lock(this->fm_mutex);
+    return this->fm_gun_ids.empty();
+}
+
+std::size_t FireMissionStore::find(unsigned int gun_id, unsigned int target_id) const {
+    std::shared_lock lock(this->fm_mutex);
+    auto it = this->fm_rows.find(makeKey(gun_id, target_id));
+    return it == this->fm_rows.end() ? npos : it->second;
+}
+
+std::span<const std::size_t> FireMissionStore::findRows(
+        const std::unordered_map<unsigned int, std::vector<std::size_t>> &index, unsigned int id) {
+    auto it = index.find(id);
+    if (it == index.end()) {
+        return {};
+    }
+    return it->second;
+}
+
+std::vector<std::size_t> FireMissionStore::getGunRows(unsigned int gun_id) const {
+    std::shared_lock lock(this->fm_mutex);
+    auto rows = findRows(this->fm_gun_rows, gun_id);
+    return {rows.begin(), rows.end()};
+}
+
+std::vector<std::size_t> FireMissionStore::getTargetRows(unsigned int target_id) const {
+    std::shared_lock lock(this->fm_mutex);
+    auto rows = findRows(this->fm_target_rows, target_id);
+    return {rows.begin(), rows.end()};
+}
+
+std::size_t FireMissionStore::countGunRows(unsigned int gun_id) const {
+    std::shared_lock lock(this->fm_mutex);
+    return findRows(this->fm_gun_rows, gun_id).size();
+}
+
+unsigned int FireMissionStore::getGunID(std::size_t row) const {
+    std::shared_lock lock(this->fm_mutex);
+    return this->fm_gun_ids[row];
+}
+
+unsigned int FireMissionStore::getTargetID(std::size_t row) const {
+    std::shared_lock lock(this->fm_mutex);
+    return this->fm_target_ids[row];
+}
+
+// calls read() under the shared lock after the row was brought up to date, so that readers only wait for readers
+// of marked rows of the same shard and never for the whole store
+template<typename F>
+auto FireMissionStore::readRow(std::size_t row, F &&read) {
+    std::shared_lock lock(this->fm_mutex);
+    if (isMarked(row)) {
+        flushMarkedRow(row);
+    }
+    return read();
+}
+
+double FireMissionStore::getDistance(std::size_t row) {
+    return readRow(row, [this, row]() { return this->fm_distance[row]; });
+}
+
+Mil FireMissionStore::getAzimuthAbs(std::size_t row) {
+    return readRow(row, [this, row]() { return this->fm_azimuth_abs[row]; });
+}
+
+int FireMissionStore::getAzimuthTurn(std::size_t row) {
+    return readRow(row, [this, row]() { return this->fm_azimuth_turn[row]; });
+}
+
+int FireMissionStore::getElevation(std::size_t row) {
+    return readRow(row, [this, row]() { return this->fm_elevation[row]; });
+}
+
+Mil FireMissionStore::getLevel(std::size_t row) {
+    return readRow(row, [this, row]() { return this->fm_level[row]; });
+}
+
+charge_type FireMissionStore::getCharge(std::size_t row) {
+    return readRow(row, [this, row]() { return this->fm_charge[row]; });
+}
+
+std::vector<double> FireMissionStore::getBallisticParameters(std::size_t row) {
+    return readRow(row, [this, row]() {
+        auto params = this->fm_ballistic.begin() + static_cast<std::ptrdiff_t>(row * BALLISTIC_ROW_STRIDE);
+        return std::vector<double>(params, params + this->fm_param_count[row]);
+    });
+}
+
+// copy of the row as a standalone parameters object, the row must be up to date
+GunTargetParameters FireMissionStore::copyParameters(std::size_t row) const {
+    GunTargetParameters params(this->fm_guns[row]);
+    params.tp_target = this->fm_target_slab.getShared(this->fm_targets[row]);
+    params.tp_gun_id = this->fm_gun_ids[row];
+    params.tp_target_id = this->fm_target_ids[row];
+    params.tp_distance = this->fm_distance[row];
+    params.tp_azimuth_abs = this->fm_azimuth_abs[row];
+    params.tp_azimuth_main = this->fm_azimuth_main[row];
+    params.tp_azimuth_res = this->fm_azimuth_res[row];
+    params.tp_azimuth_night = this->fm_azimuth_night[row];
+    params.tp_azimuth_turn = this->fm_azimuth_turn[row];
+    params.tp_elevation = this->fm_elevation[row];
+    params.tp_level = this->fm_level[row];
+    params.tp_charge = this->fm_charge[row];
+    auto ballistic = this->fm_ballistic.begin() + static_cast<std::ptrdiff_t>(row * BALLISTIC_ROW_STRIDE);
+    params.tp_ballistic_parameters.assign(ballistic, ballistic + this->fm_param_count[row]);
+    return params;
+}
+
+// copy of the row as a standalone parameters object, e.g. for printing and serialization
+GunTargetParameters FireMissionStore::getParameters(std::size_t row) {
+    return readRow(row, [this, row]() { return copyParameters(row); });
+}
+
+// parameters of the pair looked up and copied under one lock, nothing if the target is not bound to the gun
+std::optional<GunTargetParameters> FireMissionStore::findParameters(unsigned int gun_id, unsigned int target_id) {
+    std::shared_lock lock(this->fm_mutex);
+    auto it = this->fm_rows.find(makeKey(gun_id, target_id));
+    if (it == this->fm_rows.end()) {
+        return std::nullopt;
+    }
+    if (isMarked(it->second)) {
+        flushMarkedRow(it->second);
+    }
+    return copyParameters(it->second);
+}
+
+// copy of a solution of the snapshot as a standalone parameters object
+GunTargetParameters FireMissionStore::copySolution(const FireMissionSnapshot &snapshot, const GunMissions &missions,
+                                                   const FiringSolution &solution) {
+    GunTargetParameters params(missions.gm_gun);
+    auto target = std::lower_bound(snapshot.ms_targets.begin(), snapshot.ms_targets.end(), solution.fs_target_id,
+                                   [](const auto &t, unsigned int id) { return t.first < id; });
+    params.tp_target = target->second;
+    params.tp_gun_id = solution.fs_gun_id;
+    params.tp_target_id = solution.fs_target_id;
+    params.tp_distance = solution.fs_distance;
+    params.tp_azimuth_abs = solution.fs_azimuth_abs;
+    params.tp_azimuth_main = solution.fs_azimuth_main;
+    params.tp_azimuth_res = solution.fs_azimuth_res;
+    params.tp_azimuth_night = solution.fs_azimuth_night;
+    params.tp_azimuth_turn = solution.fs_azimuth_turn;
+    params.tp_elevation = solution.fs_elevation;
+    params.tp_level = solution.fs_level;
+    params.tp_charge = solution.fs_charge;
+    auto ballistic = solution.getBallisticParameters();
+    params.tp_ballistic_parameters.assign(ballistic.begin(), ballistic.end());
+    return params;
+}
+
+// the parameters below are copied out of a snapshot, so that bulk readers never hold the store lock and get the pairs
+// of a single version even while other threads bind, dismiss or move guns and targets; pairs which can't be
+// calculated are left out
+
+std::unordered_map<unsigned int, GunTargetParameters> FireMissionStore::getGunParameters(unsigned int gun_id) {
+    auto snapshot = getSnapshot();
+    std::unordered_map<unsigned int, GunTargetParameters> params;
+    if (const GunMissions *missions = snapshot->findGun(gun_id)) {
+        for (const auto &solution: missions->gm_solutions) {
+            params.emplace(solution.fs_target_id, copySolution(*snapshot, *missions, solution));
+        }
+    }
+    return params;
+}
+
+std::unordered_map<unsigned int, GunTargetParameters> FireMissionStore::getTargetParameters(unsigned int target_id) {
+    auto snapshot = getSnapshot();
+    std::unordered_map<unsigned int, GunTargetParameters> params;
+    for (const auto &missions: snapshot->getGuns()) {
+        if (const FiringSolution *solution = missions->find(target_id)) {
+            params.emplace(solution->fs_gun_id, copySolution(*snapshot, *missions, *solution));
+        }
+    }
+    return params;
+}
+
+// parameters of all pairs in ascending order of gun ID and target ID
+std::vector<GunTargetParameters> FireMissionStore::getAllParameters() {
+    auto snapshot = getSnapshot();
+    std::vector<GunTargetParameters> params;
+    params.reserve(snapshot->size());
+    for (const auto &missions: snapshot->getGuns()) {
+        for (const auto &solution: missions->gm_solutions) {
+            params.push_back(copySolution(*snapshot, *missions, solution));
+        }
+    }
+    return params;
+}
+
+std::vector<unsigned int> FireMissionStore::getBoundGunIDs(unsigned int target_id) const {
+    std::shared_lock lock(this->fm_mutex);
+    std::vector<unsigned int> gun_ids;
+    for (std::size_t row: findRows(this->fm_target_rows, target_id)) {
+        gun_ids.push_back(this->fm_gun_ids[row]);
+    }
+    return gun_ids;
+}
+
+// all bound pairs in the order of rows, also those which a snapshot leaves out because they can't be calculated
+std::vector<FireMissionBinding> FireMissionStore::getBindings() const {
+    std::shared_lock lock(this->fm_mutex);
+    std::vector<FireMissionBinding> bindings;
+    bindings.reserve(this->fm_gun_ids.size());
+    for (std::size_t row = 0; row < this->fm_gun_ids.size(); ++row) {
+        bindings.push_back({this->fm_gun_ids[row], this->fm_target_ids[row], this->fm_charge[row]});
+    }
+    return bindings;
+}
+
+// copies the current missions of the gun out of the columns, nullptr if the gun has no targets; rows which are still
+// marked could not be calculated by flushCalculable() and are left out
+std::shared_ptr<const GunMissions> FireMissionStore::buildGunMissions(unsigned int gun_id) const {
+    auto rows = findRows(this->fm_gun_rows, gun_id);
+    if (std::none_of(rows.begin(), rows.end(), [this](std::size_t row) { return this->fm_dirty[row] == fd_clean; })) {
+        return nullptr;
+    }
+    auto missions = std::make_shared<GunMissions>();
+    missions->gm_gun = this->fm_guns[rows.front()];
+    missions->gm_solutions.reserve(rows.size());
+    for (std::size_t row: rows) {
+        if (this->fm_dirty[row] != fd_clean) {
+            continue;
+        }
+        FiringSolution &solution = missions->gm_solutions.emplace_back();
+        solution.fs_gun_id = this->fm_gun_ids[row];
+        solution.fs_target_id = this->fm_target_ids[row];
+        solution.fs_distance = this->fm_distance[row];
+        solution.fs_azimuth_abs = this->fm_azimuth_abs[row];
+        solution.fs_azimuth_main = this->fm_azimuth_main[row];
+        solution.fs_azimuth_res = this->fm_azimuth_res[row];
+        solution.fs_azimuth_night = this->fm_azimuth_night[row];
+        solution.fs_azimuth_turn = this->fm_azimuth_turn[row];
+        solution.fs_elevation = this->fm_elevation[row];
+        solution.fs_level = this->fm_level[row];
+        solution.fs_charge = this->fm_charge[row];
+        solution.fs_param_count = this->fm_param_count[row];
+        solution.fs_ballistic = {};
+        std::copy_n(this->fm_ballistic.begin() + static_cast<std::ptrdiff_t>(row * BALLISTIC_ROW_STRIDE),
+                    this->fm_param_count[row], solution.fs_ballistic.begin());
+    }
+    std::sort(missions->gm_solutions.begin(), missions->gm_solutions.end(),
+              [](const FiringSolution &a, const FiringSolution &b) { return a.fs_target_id < b.fs_target_id; });
+    return missions;
+}
+
+// takes the elements of the previous snapshot (sorted by key) and replaces the ones with changed keys by build(key),
+// elements for which build() returns nothing are dropped
+template<typename T, typename K, typename B>
+static std::vector<T> mergeChanges(const std::vector<T> &previous, const std::unordered_set<unsigned int> &changed,
+                                   K &&key, B &&build) {
+    std::vector<unsigned int> changed_keys(changed.begin(), changed.end());
+    std::sort(changed_keys.begin(), changed_keys.end());
+    std::vector<T> merged;
+    merged.reserve(previous.size() + changed_keys.size());
+    auto it = previous.begin();
+    for (unsigned int k: changed_keys) {
+        for (; it != previous.end() && key(*it) < k; ++it) {
+            merged.push_back(*it);
+        }
+        if (it != previous.end() && key(*it) == k) {
+            ++it;
+        }
+        if (std::optional<T> element = build(k)) {
+            merged.push_back(std::move(*element));
+        }
+    }
+    merged.insert(merged.end(), it, previous.end());
+    return merged;
+}
+
+// builds the snapshot of the current version out of the published one, only changed guns and targets are copied
+std::shared_ptr<const FireMissionSnapshot> FireMissionStore::publish() {
+    auto previous = this->fm_snapshot.load();
+    u_int64_t version = this->fm_version.load();
+    if (previous && previous->ms_version == version) {
+        return previous;
+    }
+    flushCalculable();
+    static const FireMissionSnapshot empty_snapshot;
+    const FireMissionSnapshot &base = previous ? *previous : empty_snapshot;
+    if (!previous) {
+        for (const auto &gun_rows: this->fm_gun_rows) {
+            this->fm_changed_guns.insert(gun_rows.first);
+        }
+        for (const auto &target_rows: this->fm_target_rows) {
+            this->fm_changed_targets.insert(target_rows.first);
+        }
+    }
+    auto next = std::make_shared<FireMissionSnapshot>();
+    next->ms_version = version;
+    next->ms_guns = mergeChanges(
+            base.ms_guns, this->fm_changed_guns,
+            [](const std::shared_ptr<const GunMissions> &missions) { return missions->gm_gun->getGunID(); },
+            [this](unsigned int gun_id) -> std::optional<std::shared_ptr<const GunMissions>> {
+                if (auto missions = buildGunMissions(gun_id)) {
+                    return missions;
+                }
+                return std::nullopt;
+            });
+    next->ms_targets = mergeChanges(
+            base.ms_targets, this->fm_changed_targets,
+            [](const std::pair<unsigned int, std::shared_ptr<const Target>> &target) { return target.first; },
+            [this](unsigned int target_id) -> std::optional<std::pair<unsigned int, std::shared_ptr<const Target>>> {
+                auto rows = findRows(this->fm_target_rows, target_id);
+                if (rows.empty()) {
+                    return std::nullopt;
+                }
+                return std::make_pair(target_id, this->fm_target_slab.getShared(this->fm_targets[rows.front()]));
+            });
+    this->fm_changed_guns.clear();
+    this->fm_changed_targets.clear();
+    this->fm_snapshot.store(next);
+    return next;
+}
+
+// snapshot of the current version; the published snapshot is returned without locking if nothing changed since,
+// otherwise the changed parts are published first
+std::shared_ptr<const FireMissionSnapshot> FireMissionStore::getSnapshot() {
+    auto current = this->fm_snapshot.load();
+    if (current && current->ms_version == this->fm_version.load()) {
+        return current;
+    }
+    std::unique_lock lock(this->fm_mutex);
+    return publish();
+}
+
+u_int64_t FireMissionStore::getVersion() const {
+    return this->fm_version.load();
+}
+
+std::span<const double> FiringSolution::getBallisticParameters() const {
+    return {this->fs_ballistic.data(), this->fs_param_count};
+}
+
+const FiringSolution *GunMissions::find(unsigned int target_id) const {
+    auto it = std::lower_bound(this->gm_solutions.begin(), this->gm_solutions.end(), target_id,
+                               [](const FiringSolution &s, unsigned int id) { return s.fs_target_id < id; });
+    return it != this->gm_solutions.end() && it->fs_target_id == target_id ? &*it : nullptr;
+}
+
+u_int64_t FireMissionSnapshot::getVersion() const {
+    return this->ms_version;
+}
+
+std::span<const std::shared_ptr<const GunMissions>> FireMissionSnapshot::getGuns() const {
+    return this->ms_guns;
+}
+
+std::span<const std::pair<unsigned int, std::shared_ptr<const Target>>> FireMissionSnapshot::getTargets() const {
+    return this->ms_targets;
+}
+
+const GunMissions *FireMissionSnapshot::findGun(unsigned int gun_id) const {
+    auto it = std::lower_bound(this->ms_guns.begin(), this->ms_guns.end(), gun_id,
+                               [](const std::shared_ptr<const GunMissions> &m, unsigned int id) {
+                                   return m->gm_gun->getGunID() < id;
+                               });
+    return it != this->ms_guns.end() && (*it)->gm_gun->getGunID() == gun_id ? it->get() : nullptr;
+}
+
+const Target *FireMissionSnapshot::findTarget(unsigned int target_id) const {
+    auto it = std::lower_bound(this->ms_targets.begin(), this->ms_targets.end(), target_id,
+                               [](const auto &t, unsigned int id) { return t.first < id; });
+    return it != this->ms_targets.end() && it->first == target_id ? it->second.get() : nullptr;
+}
+
+const FiringSolution *FireMissionSnapshot::find(unsigned int gun_id, unsigned int target_id) const {
+    const GunMissions *missions = findGun(gun_id);
+    return missions ? missions->find(target_id) : nullptr;
+}
+
+std::size_t FireMissionSnapshot::size() const {
+    std::size_t count = 0;
+    for (const auto &missions: this->ms_guns) {
+        count += missions->gm_solutions.size();
+    }
+    return count;
+}
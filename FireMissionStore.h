@@ -0,0 +1,188 @@
+#ifndef ACE_ARTILLERY1_0_FIREMISSIONSTORE_H
+#define ACE_ARTILLERY1_0_FIREMISSIONSTORE_H
+
+#include "dependencies.h"
+#include "Gun.h"
+#include "TargetSlab.h"
+#include <array>
+#include <atomic>
+#include <mutex>
+#include <optional>
+#include <shared_mutex>
+
+// number of locks under which readers bring marked rows up to date, a row belongs to the lock of its gun
+constexpr std::size_t FIRE_MISSION_SHARD_COUNT = 16;
+
+// parts of a row which are out of date after a change of the gun or the target
+enum fire_mission_dirty : u_int8_t {
+    fd_clean     = 0,
+    fd_direction = 1,       // gun direction changed: only mission azimuths and turn are recalculated
+    fd_position  = 2        // gun or target position changed: the whole row is recalculated
+};
+
+// firing data of one gun-target pair as published in a FireMissionSnapshot
+struct FiringSolution {
+    unsigned int fs_gun_id;                                 // Gun ID
+    unsigned int fs_target_id;                              // Target ID
+    double fs_distance;                                     // Target Distance
+    Mil fs_azimuth_abs;                                     // Target Azimuth w.r.t. True South (00-00 Mil) Counterclockwise
+    Mil fs_azimuth_main;                                    // Mission Azimuth w.r.t. Main Reference Point    (MRP)
+    Mil fs_azimuth_res;                                     // Mission Azimuth w.r.t. Reserve Reference Point (RRP)
+    Mil fs_azimuth_night;                                   // Mission Azimuth w.r.t. Night Reference Point   (NRP)
+    int fs_azimuth_turn;                                    // Azimuth Correction w.r.t. Mission Azimuth
+    int fs_elevation;                                       // Elevation
+    Mil fs_level;                                           // Level
+    charge_type fs_charge;                                  // Charge Type
+    u_int8_t fs_param_count;                                // Number of ballistic parameters (0 if out of table range)
+    BallisticRow fs_ballistic;                              // Ballistic parameters, first fs_param_count are valid
+    [[nodiscard]] std::span<const double> getBallisticParameters() const;
+};
+
+// gun-target pair bound in the store, whether or not its firing data can be calculated
+struct FireMissionBinding {
+    unsigned int fb_gun_id;                                 // Gun ID
+    unsigned int fb_target_id;                              // Target ID
+    charge_type fb_charge;                                  // Charge Type
+};
+
+// missions of one gun as published in a FireMissionSnapshot, shared by all snapshots until the gun or its targets change
+struct GunMissions {
+    std::shared_ptr<const Gun> gm_gun;                      // Gun as it was when the missions were published
+    std::vector<FiringSolution> gm_solutions;               // Firing data in ascending order of target ID
+    [[nodiscard]] const FiringSolution* find(unsigned int target_id) const;
+};
+
+// immutable view of all fire missions at one version of the store; unchanged guns and targets are shared
+// with the previous version, so publishing costs only the parts which changed and holding a snapshot costs nothing;
+// pairs whose firing data can't be calculated (e.g. the gun stands on the target) are left out of it
+class FireMissionSnapshot {
+private:
+    u_int64_t ms_version = 0;                                                           // Version of the store
+    std::vector<std::shared_ptr<const GunMissions>> ms_guns;                            // Missions in ascending order of gun ID
+    std::vector<std::pair<unsigned int, std::shared_ptr<const Target>>> ms_targets;     // Bound targets in ascending order of ID
+    friend class FireMissionStore;
+public:
+    [[nodiscard]] u_int64_t getVersion() const;
+    [[nodiscard]] std::span<const std::shared_ptr<const GunMissions>> getGuns() const;
+    [[nodiscard]] std::span<const std::pair<unsigned int, std::shared_ptr<const Target>>> getTargets() const;
+    [[nodiscard]] const GunMissions* findGun(unsigned int gun_id) const;
+    [[nodiscard]] const Target* findTarget(unsigned int target_id) const;
+    [[nodiscard]] const FiringSolution* find(unsigned int gun_id, unsigned int target_id) const;
+    [[nodiscard]] std::size_t size() const;
+};
+
+// firing data of all gun-target pairs kept column by column: i-th element of every column belongs to i-th pair,
+// a pair is found by (gun ID, target ID) and all pairs of a gun or of a target are found through secondary indexes;
+// rows are moved when another row is erased, so row numbers are only valid until the next erasure;
+// changes of guns and targets only mark the rows, which are recalculated when read or on flush();
+// bulk recalculations (flush(), updateGun(), updateAll()) are split over the shared thread pool;
+// all methods may be called from several threads: changes take the store lock exclusively, reads of single rows share
+// it and calculate a marked row in place under the lock of the gun's shard, so that readers never wait for the whole
+// store; row numbers may be changed by another thread at any time, so concurrent readers should read many rows
+// through a snapshot, which is what the methods returning the parameters of a gun, of a target or of all pairs do
+class FireMissionStore {
+private:
+    mutable std::shared_mutex fm_mutex;                     // Guards all columns and indexes
+    std::array<std::mutex, FIRE_MISSION_SHARD_COUNT> fm_shard_mutexes;         // Guard calculation of marked rows by readers
+    std::vector<unsigned int> fm_gun_ids;                   // Gun ID
+    std::vector<unsigned int> fm_target_ids;                // Target ID
+    std::vector<std::shared_ptr<const Gun>> fm_guns;        // Copy of the gun to which the target is bound, shared by its rows
+    std::vector<TargetHandle> fm_targets;                   // Target in fm_target_slab
+    std::vector<double> fm_distance;                        // Target Distance
+    std::vector<Mil> fm_azimuth_abs;                        // Target Azimuth w.r.t. True South (00-00 Mil) Counterclockwise
+    std::vector<Mil> fm_azimuth_main;                       // Mission Azimuth w.r.t. Main Reference Point    (MRP)
+    std::vector<Mil> fm_azimuth_res;                        // Mission Azimuth w.r.t. Reserve Reference Point (RRP)
+    std::vector<Mil> fm_azimuth_night;                      // Mission Azimuth w.r.t. Night Reference Point   (NRP)
+    std::vector<int> fm_azimuth_turn;                       // Azimuth Correction w.r.t. Mission Azimuth
+    std::vector<int> fm_elevation;                          // Elevation
+    std::vector<Mil> fm_level;                              // Level
+    std::vector<charge_type> fm_charge;                     // Charge Type
+    std::vector<u_int8_t> fm_param_count;                   // Number of ballistic parameters of the row (0 if out of table range)
+    std::vector<double> fm_ballistic;                       // Ballistic parameters, i-th row starts at i * BALLISTIC_ROW_STRIDE
+    TargetSlab fm_target_slab;                              // Bound targets, each kept once for all its rows (apart from target_map)
+    std::vector<u_int8_t> fm_dirty;                         // Combination of fire_mission_dirty flags, cleared atomically by readers
+    std::atomic<std::size_t> fm_dirty_count = 0;            // Number of rows with any fire_mission_dirty flag set
+    std::unordered_map<u_int64_t, std::size_t> fm_rows;     // (gun ID, target ID) -> row
+    std::unordered_map<unsigned int, std::vector<std::size_t>> fm_gun_rows;     // Gun ID -> rows of its targets
+    std::unordered_map<unsigned int, std::vector<std::size_t>> fm_target_rows;  // Target ID -> rows of guns bound to it
+    std::atomic<u_int64_t> fm_version = 0;                  // Increased on every change of the rows
+    std::atomic<std::shared_ptr<const FireMissionSnapshot>> fm_snapshot;        // Last published snapshot (null if none)
+    std::unordered_set<unsigned int> fm_changed_guns;       // Guns whose missions changed since fm_snapshot
+    std::unordered_set<unsigned int> fm_changed_targets;    // Targets bound, dismissed or moved since fm_snapshot
+    static u_int64_t makeKey(unsigned int gun_id, unsigned int target_id);
+    static void replaceRow(std::vector<std::size_t>& rows, std::size_t from, std::size_t to);
+    static std::span<const std::size_t> findRows(const std::unordered_map<unsigned int, std::vector<std::size_t>>& index,
+                                                 unsigned int id);
+    std::size_t insertRow(const Gun& gun, const Target& target, charge_type charge, bool calculate);
+    void eraseRow(std::size_t row);
+    void eraseKey(unsigned int gun_id, unsigned int target_id);
+    void markRow(std::size_t row, fire_mission_dirty flag);
+    void replaceGun(std::span<const std::size_t> rows, const Gun& gun);
+    void noteGunChange(unsigned int gun_id);
+    void noteTargetChange(unsigned int target_id);
+    void noteFullChange();
+    std::shared_ptr<const GunMissions> buildGunMissions(unsigned int gun_id) const;
+    std::shared_ptr<const FireMissionSnapshot> publish();
+    void computeRow(std::size_t row);
+    void applyGeometry(std::size_t row, const TargetGeometry& geometry);
+    void computeGunRows(std::span<const std::size_t> rows);
+    void computeDirection(std::size_t row);
+    void computeMarkedRow(std::size_t row);
+    void forEachRow(std::span<const std::size_t> rows, const std::function<void(std::size_t)>& body);
+    void recountDirty();
+    void refreshRow(std::size_t row);
+    [[nodiscard]] bool isMarked(std::size_t row) const;
+    void flushMarkedRow(std::size_t row);
+    void flushAll();
+    void flushCalculable();
+    [[nodiscard]] GunTargetParameters copyParameters(std::size_t row) const;
+    static GunTargetParameters copySolution(const FireMissionSnapshot& snapshot, const GunMissions& missions,
+                                            const FiringSolution& solution);
+    template<typename F>
+    auto readRow(std::size_t row, F&& read);
+public:
+    static constexpr std::size_t npos = static_cast<std::size_t>(-1);
+
+    std::size_t insert(const Gun& gun, const Target& target, charge_type charge);
+    std::size_t restore(const Gun& gun, const Target& target, charge_type charge);
+    void erase(unsigned int gun_id, unsigned int target_id);
+    void eraseGun(unsigned int gun_id);
+    void clear();
+    void updateRow(std::size_t row);
+    void updateGun(const Gun& gun);
+    void updateAll();
+    void updateTarget(const Target& target);
+    void invalidateGun(const Gun& gun, fire_mission_dirty flag);
+    void flush();
+    [[nodiscard]] bool isDirty(std::size_t row) const;
+    [[nodiscard]] std::size_t countDirty() const;
+    [[nodiscard]] std::size_t size() const;
+    [[nodiscard]] bool empty() const;
+    [[nodiscard]] std::size_t find(unsigned int gun_id, unsigned int target_id) const;
+    [[nodiscard]] std::vector<std::size_t> getGunRows(unsigned int gun_id) const;
+    [[nodiscard]] std::vector<std::size_t> getTargetRows(unsigned int target_id) const;
+    [[nodiscard]] std::size_t countGunRows(unsigned int gun_id) const;
+    [[nodiscard]] unsigned int getGunID(std::size_t row) const;
+    [[nodiscard]] unsigned int getTargetID(std::size_t row) const;
+    [[nodiscard]] double getDistance(std::size_t row);
+    [[nodiscard]] Mil getAzimuthAbs(std::size_t row);
+    [[nodiscard]] int getAzimuthTurn(std::size_t row);
+    [[nodiscard]] int getElevation(std::size_t row);
+    [[nodiscard]] Mil getLevel(std::size_t row);
+    [[nodiscard]] charge_type getCharge(std::size_t row);
+    [[nodiscard]] std::vector<double> getBallisticParameters(std::size_t row);
+    [[nodiscard]] GunTargetParameters getParameters(std::size_t row);
+    [[nodiscard]] std::optional<GunTargetParameters> findParameters(unsigned int gun_id, unsigned int target_id);
+    [[nodiscard]] std::unordered_map<unsigned int, GunTargetParameters> getGunParameters(unsigned int gun_id);
+    [[nodiscard]] std::unordered_map<unsigned int, GunTargetParameters> getTargetParameters(unsigned int target_id);
+    [[nodiscard]] std::vector<GunTargetParameters> getAllParameters();
+    [[nodiscard]] std::vector<unsigned int> getBoundGunIDs(unsigned int target_id) const;
+    [[nodiscard]] std::vector<FireMissionBinding> getBindings() const;
+    [[nodiscard]] std::shared_ptr<const FireMissionSnapshot> getSnapshot();
+    [[nodiscard]] u_int64_t getVersion() const;
+};
+
+// firing data of all gun-target pairs
+extern FireMissionStore gun_target_parameters;
+
+#endif //ACE_ARTILLERY1_0_FIREMISSIONSTORE_H
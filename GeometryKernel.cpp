@@ -0,0 +1,204 @@
+#include "GeometryKernel.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define ACE_X86_KERNELS
+#endif
+
+// coefficients of the rational approximation atan(s) = s + s * z * P(z) / Q(z), z = s * s, for |s| <= 0.66
+// (Cephes), the leading coefficient of Q is 1
+static constexpr double ATAN_P0 = -8.750608600031904122785e-1;
+static constexpr double ATAN_P1 = -1.615753718733365076637e1;
+static constexpr double ATAN_P2 = -7.500855792314704667340e1;
+static constexpr double ATAN_P3 = -1.228866684490136173410e2;
+static constexpr double ATAN_P4 = -6.485021904942025371773e1;
+static constexpr double ATAN_Q0 = 2.485846490142306297962e1;
+static constexpr double ATAN_Q1 = 1.650270098316988542046e2;
+static constexpr double ATAN_Q2 = 4.328810604912902668951e2;
+static constexpr double ATAN_Q3 = 4.853903996359136964868e2;
+static constexpr double ATAN_Q4 = 1.945506571482613964425e2;
+
+// ratios above it are reduced by atan(r) = pi / 4 + atan((r - 1) / (r + 1))
+static constexpr double ATAN_REDUCTION = 0.66;
+
+// atan(y / x) for x != 0: the ratio of the smaller to the larger absolute value is taken, so that it lies in [0, 1]
+// and the result is mirrored by pi / 2 - atan(1 / r) if |y| > |x|; the sign is restored at the end;
+// SIMD kernels do the same operations in the same order lane by lane, selecting instead of branching
+static double atanRatio(double y, double x) {
+    double a = std::fabs(y);
+    double b = std::fabs(x);
+    bool swap = a > b;
+    double r = (swap ? b : a) / (swap ? a : b);
+    bool shift = r > ATAN_REDUCTION;
+    double s = shift ? (r - 1) / (r + 1) : r;
+    double z = s * s;
+    double p = (((ATAN_P0 * z + ATAN_P1) * z + ATAN_P2) * z + ATAN_P3) * z + ATAN_P4;
+    double q = ((((z + ATAN_Q0) * z + ATAN_Q1) * z + ATAN_Q2) * z + ATAN_Q3) * z + ATAN_Q4;
+    double t = s * (z * p / q) + s;
+    t = t + (shift ? constants::pi / 4 : 0.);
+    t = swap ? constants::pi / 2 - t : t;
+    return std::signbit(y) != std::signbit(x) ? -t : t;
+}
+
+void solveGeometryKernelScalar(double gun_x, double gun_y, double gun_h, const double *tg_x, const double *tg_y,
+                               const double *tg_h, double *distance, double *azimuth, double *level, std::size_t n) {
+    for (std::size_t i = 0; i < n; ++i) {
+        double dX = tg_x[i] - gun_x;
+        double dY = tg_y[i] - gun_y;
+        double dH = tg_h[i] - gun_h;
+        double d = sqrt(dX * dX + dY * dY);
+        distance[i] = d;
+        azimuth[i] = atanRatio(dY, dX) * 3000 / constants::pi;
+        level[i] = atanRatio(dH, d) * 3000 / constants::pi;
+    }
+}
+
+#ifdef ACE_X86_KERNELS
+
+__attribute__((target("sse2")))
+static inline __m128d selectSSE2(__m128d mask, __m128d a, __m128d b) {
+    return _mm_or_pd(_mm_and_pd(mask, a), _mm_andnot_pd(mask, b));
+}
+
+__attribute__((target("sse2")))
+static inline __m128d atanRatioSSE2(__m128d y, __m128d x) {
+    const __m128d sign = _mm_set1_pd(-0.);
+    __m128d a = _mm_andnot_pd(sign, y);
+    __m128d b = _mm_andnot_pd(sign, x);
+    __m128d swap = _mm_cmpgt_pd(a, b);
+    __m128d r = _mm_div_pd(selectSSE2(swap, b, a), selectSSE2(swap, a, b));
+    __m128d shift = _mm_cmpgt_pd(r, _mm_set1_pd(ATAN_REDUCTION));
+    const __m128d one = _mm_set1_pd(1.);
+    __m128d s = selectSSE2(shift, _mm_div_pd(_mm_sub_pd(r, one), _mm_add_pd(r, one)), r);
+    __m128d z = _mm_mul_pd(s, s);
+    __m128d p = _mm_add_pd(_mm_mul_pd(_mm_set1_pd(ATAN_P0), z), _mm_set1_pd(ATAN_P1));
+    p = _mm_add_pd(_mm_mul_pd(p, z), _mm_set1_pd(ATAN_P2));
+    p = _mm_add_pd(_mm_mul_pd(p, z), _mm_set1_pd(ATAN_P3));
+    p = _mm_add_pd(_mm_mul_pd(p, z), _mm_set1_pd(ATAN_P4));
+    __m128d q = _mm_add_pd(z, _mm_set1_pd(ATAN_Q0));
+    q = _mm_add_pd(_mm_mul_pd(q, z), _mm_set1_pd(ATAN_Q1));
+    q = _mm_add_pd(_mm_mul_pd(q, z), _mm_set1_pd(ATAN_Q2));
+    q = _mm_add_pd(_mm_mul_pd(q, z), _mm_set1_pd(ATAN_Q3));
+    q = _mm_add_pd(_mm_mul_pd(q, z), _mm_set1_pd(ATAN_Q4));
+    __m128d t = _mm_add_pd(_mm_mul_pd(s, _mm_div_pd(_mm_mul_pd(z, p), q)), s);
+    t = _mm_add_pd(t, _mm_and_pd(shift, _mm_set1_pd(constants::pi / 4)));
+    t = selectSSE2(swap, _mm_sub_pd(_mm_set1_pd(constants::pi / 2), t), t);
+    return _mm_xor_pd(t, _mm_and_pd(sign, _mm_xor_pd(y, x)));
+}
+
+__attribute__((target("sse2")))
+void solveGeometryKernelSSE2(double gun_x, double gun_y, double gun_h, const double *tg_x, const double *tg_y,
+                             const double *tg_h, double *distance, double *azimuth, double *level, std::size_t n) {
+    const __m128d gx = _mm_set1_pd(gun_x);
+    const __m128d gy = _mm_set1_pd(gun_y);
+    const __m128d gh = _mm_set1_pd(gun_h);
+    const __m128d mil = _mm_set1_pd(3000);
+    const __m128d pi = _mm_set1_pd(constants::pi);
+    std::size_t i = 0;
+    for (; i + 2 <= n; i += 2) {
+        __m128d dX = _mm_sub_pd(_mm_loadu_pd(tg_x + i), gx);
+        __m128d dY = _mm_sub_pd(_mm_loadu_pd(tg_y + i), gy);
+        __m128d dH = _mm_sub_pd(_mm_loadu_pd(tg_h + i), gh);
+        __m128d d = _mm_sqrt_pd(_mm_add_pd(_mm_mul_pd(dX, dX), _mm_mul_pd(dY, dY)));
+        _mm_storeu_pd(distance + i, d);
+        _mm_storeu_pd(azimuth + i, _mm_div_pd(_mm_mul_pd(atanRatioSSE2(dY, dX), mil), pi));
+        _mm_storeu_pd(level + i, _mm_div_pd(_mm_mul_pd(atanRatioSSE2(dH, d), mil), pi));
+    }
+    solveGeometryKernelScalar(gun_x, gun_y, gun_h, tg_x + i, tg_y + i, tg_h + i, distance + i, azimuth + i, level + i,
+                              n - i);
+}
+
+__attribute__((target("avx2")))
+static inline __m256d atanRatioAVX2(__m256d y, __m256d x) {
+    const __m256d sign = _mm256_set1_pd(-0.);
+    __m256d a = _mm256_andnot_pd(sign, y);
+    __m256d b = _mm256_andnot_pd(sign, x);
+    __m256d swap = _mm256_cmp_pd(a, b, _CMP_GT_OQ);
+    __m256d r = _mm256_div_pd(_mm256_blendv_pd(a, b, swap), _mm256_blendv_pd(b, a, swap));
+    __m256d shift = _mm256_cmp_pd(r, _mm256_set1_pd(ATAN_REDUCTION), _CMP_GT_OQ);
+    const __m256d one = _mm256_set1_pd(1.);
+    __m256d s = _mm256_blendv_pd(r, _mm256_div_pd(_mm256_sub_pd(r, one), _mm256_add_pd(r, one)), shift);
+    __m256d z = _mm256_mul_pd(s, s);
+    __m256d p = _mm256_add_pd(_mm256_mul_pd(_mm256_set1_pd(ATAN_P0), z), _mm256_set1_pd(ATAN_P1));
+    p = _mm256_add_pd(_mm256_mul_pd(p, z), _mm256_set1_pd(ATAN_P2));
+    p = _mm256_add_pd(_mm256_mul_pd(p, z), _mm256_set1_pd(ATAN_P3));
+    p = _mm256_add_pd(_mm256_mul_pd(p, z), _mm256_set1_pd(ATAN_P4));
+    __m256d q = _mm256_add_pd(z, _mm256_set1_pd(ATAN_Q0));
+    q = _mm256_add_pd(_mm256_mul_pd(q, z), _mm256_set1_pd(ATAN_Q1));
+    q = _mm256_add_pd(_mm256_mul_pd(q, z), _mm256_set1_pd(ATAN_Q2));
+    q = _mm256_add_pd(_mm256_mul_pd(q, z), _mm256_set1_pd(ATAN_Q3));
+    q = _mm256_add_pd(_mm256_mul_pd(q, z), _mm256_set1_pd(ATAN_Q4));
+    __m256d t = _mm256_add_pd(_mm256_mul_pd(s, _mm256_div_pd(_mm256_mul_pd(z, p), q)), s);
+    t = _mm256_add_pd(t, _mm256_and_pd(shift, _mm256_set1_pd(constants::pi / 4)));
+    t = _mm256_blendv_pd(t, _mm256_sub_pd(_mm256_set1_pd(constants::pi / 2), t), swap);
+    return _mm256_xor_pd(t, _mm256_and_pd(sign, _mm256_xor_pd(y, x)));
+}
+
+__attribute__((target("avx2")))
+void solveGeometryKernelAVX2(double gun_x, double gun_y, double gun_h, const double *tg_x, const double *tg_y,
+                             const double *tg_h, double *distance, double *azimuth, double *level, std::size_t n) {
+    const __m256d gx = _mm256_set1_pd(gun_x);
+    const __m256d gy = _mm256_set1_pd(gun_y);
+    const __m256d gh = _mm256_set1_pd(gun_h);
+    const __m256d mil = _mm256_set1_pd(3000);
+    const __m256d pi = _mm256_set1_pd(constants::pi);
+    std::size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        __m256d dX = _mm256_sub_pd(_mm256_loadu_pd(tg_x + i), gx);
+        __m256d dY = _mm256_sub_pd(_mm256_loadu_pd(tg_y + i), gy);
+        __m256d dH = _mm256_sub_pd(_mm256_loadu_pd(tg_h + i), gh);
+        __m256d d = _mm256_sqrt_pd(_mm256_add_pd(_mm256_mul_pd(dX, dX), _mm256_mul_pd(dY, dY)));
+        _mm256_storeu_pd(distance + i, d);
+        _mm256_storeu_pd(azimuth + i, _mm256_div_pd(_mm256_mul_pd(atanRatioAVX2(dY, dX), mil), pi));
+        _mm256_storeu_pd(level + i, _mm256_div_pd(_mm256_mul_pd(atanRatioAVX2(dH, d), mil), pi));
+    }
+    solveGeometryKernelSSE2(gun_x, gun_y, gun_h, tg_x + i, tg_y + i, tg_h + i, distance + i, azimuth + i, level + i,
+                            n - i);
+}
+
+#else
+
+void solveGeometryKernelSSE2(double gun_x, double gun_y, double gun_h, const double *tg_x, const double *tg_y,
+                             const double *tg_h, double *distance, double *azimuth, double *level, std::size_t n) {
+    solveGeometryKernelScalar(gun_x, gun_y, gun_h, tg_x, tg_y, tg_h, distance, azimuth, level, n);
+}
+
+void solveGeometryKernelAVX2(double gun_x, double gun_y, double gun_h, const double *tg_x, const double *tg_y,
+                             const double *tg_h, double *distance, double *azimuth, double *level, std::size_t n) {
+    solveGeometryKernelScalar(gun_x, gun_y, gun_h, tg_x, tg_y, tg_h, distance, azimuth, level, n);
+}
+
+#endif
+
+using GeometryKernel = void (*)(double, double, double, const double *, const double *, const double *,
+                                double *, double *, double *, std::size_t);
+
+static GeometryKernel chooseGeometryKernel() {
+#ifdef ACE_X86_KERNELS
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) {
+        return solveGeometryKernelAVX2;
+    }
+    return solveGeometryKernelSSE2;
+#else
+    return solveGeometryKernelScalar;
+#endif
+}
+
+// chosen on first use rather than during static initialization, so that static initializers of other translation
+// units may already call the kernel
+static GeometryKernel geometryKernel() {
+    static const GeometryKernel kernel = chooseGeometryKernel();
+    return kernel;
+}
+
+void solveGeometryKernel(double gun_x, double gun_y, double gun_h, const double *tg_x, const double *tg_y,
+                         const double *tg_h, double *distance, double *azimuth, double *level, std::size_t n) {
+    geometryKernel()(gun_x, gun_y, gun_h, tg_x, tg_y, tg_h, distance, azimuth, level, n);
+}
+
+std::string getGeometryKernelName() {
+    if (geometryKernel() == solveGeometryKernelAVX2) return "avx2";
+    if (geometryKernel() == solveGeometryKernelSSE2) return "sse2";
+    return "scalar";
+}
@@ -0,0 +1,30 @@
+#ifndef ACE_ARTILLERY1_0_GEOMETRYKERNEL_H
+#define ACE_ARTILLERY1_0_GEOMETRYKERNEL_H
+
+#include "dependencies.h"
+
+// largest difference in Mil between an angle given by the geometry kernels and the same angle calculated with std::atan,
+// the polynomial itself is accurate to about 1e-12 Mil, the bound leaves room for rounding of the different operations
+constexpr double GEOMETRY_KERNEL_ERROR = 1e-6;
+
+// geometry of n targets w.r.t. a gun at (gun_x, gun_y, gun_h):
+// distance[i] = sqrt(dX * dX + dY * dY), bit-identical to calcDistance()
+// azimuth[i] ~ atan(dY / dX) * 3000 / pi, the angle of calcAbsAngle() before truncation and the quadrant offset
+// level[i] ~ atan(dH / distance[i]) * 3000 / pi, the angle of calcLevel() before truncation
+// angles are evaluated with a rational approximation of atan, all kernels give bit-identical results;
+// the results of targets closer to the gun than the minimum distance are not defined
+void solveGeometryKernelScalar(double gun_x, double gun_y, double gun_h, const double* tg_x, const double* tg_y,
+                               const double* tg_h, double* distance, double* azimuth, double* level, std::size_t n);
+void solveGeometryKernelSSE2(double gun_x, double gun_y, double gun_h, const double* tg_x, const double* tg_y,
+                             const double* tg_h, double* distance, double* azimuth, double* level, std::size_t n);
+void solveGeometryKernelAVX2(double gun_x, double gun_y, double gun_h, const double* tg_x, const double* tg_y,
+                             const double* tg_h, double* distance, double* azimuth, double* level, std::size_t n);
+
+// kernel chosen once at runtime: AVX2 if the processor supports it, SSE2 on other x86 processors, scalar otherwise
+void solveGeometryKernel(double gun_x, double gun_y, double gun_h, const double* tg_x, const double* tg_y,
+                         const double* tg_h, double* distance, double* azimuth, double* level, std::size_t n);
+
+// name of the kernel chosen by solveGeometryKernel() ("avx2", "sse2" or "scalar")
+std::string getGeometryKernelName();
+
+#endif //ACE_ARTILLERY1_0_GEOMETRYKERNEL_H
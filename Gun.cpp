@@ -1,22 +1,16 @@
 #include "Gun.h"
+#include "FireMissionStore.h"
+#include "GeometryKernel.h"
 
 #include <utility>
 #include "dependencies.h"
 
-std::unordered_map<unsigned int, std::unordered_map<unsigned int, GunTargetParameters>> gun_target_parameters;
+Registry<Gun> gun_map;
 
-std::unordered_map<unsigned int, Gun> gun_map;
-
-std::unordered_map<unsigned int, Target> target_map;
+Registry<Target> target_map;
 
 std::vector<GunTargetParameters> getGunTargetParameters() {
-    std::vector<GunTargetParameters> all_parameters;
-    for (const auto& outerPair : gun_target_parameters) {
-        for (const auto& innerPair : outerPair.second) {
-            all_parameters.push_back(innerPair.second);
-        }
-    }
-    return all_parameters;
+    return gun_target_parameters.getAllParameters();
 }
 
 Gun::Gun(const double &gun_x, const double &gun_y, const double &gun_h) {
@@ -35,20 +29,21 @@ Gun::Gun(const double &gun_x, const double &gun_y, const double &gun_h) {
     this->gun_ID = generateUniqueID();
     this->gun_name = "gun" + std::to_string(this->gun_ID);
     this->gun_description = "none";
-    this->gun_charges = {
-            {lt_full,    0},
-            {lt_reduced, 0},
-            {lt_1st,     0},
-            {lt_2nd,     0},
-            {lt_3rd,     0},
-            {lt_4th,     0}
-    };
     this->gun_covers.clear();
 }
 
 Gun::Gun(const double &gun_x, const double &gun_y, const double &gun_h,
          const Mil &gun_dir, const Mil &gun_dir_main, const Mil &gun_dir_res, const Mil &gun_dir_night,
-         const std::string &name, const std::string &description, const std::map<charge_type, unsigned int> &charges,
+         const std::string &name, const std::string &description, const ChargeInventory &charges,
+         const std::vector<std::tuple<Mil, Mil, int, int>> &covers)
+        : Gun(generateUniqueID(), gun_x, gun_y, gun_h, gun_dir, gun_dir_main, gun_dir_res, gun_dir_night,
+              name, description, charges, covers) {
+}
+
+// gun with a given ID, e.g. loaded from the object store; the caller keeps generateUniqueID() past it, see reserveUniqueID()
+Gun::Gun(unsigned int id, const double &gun_x, const double &gun_y, const double &gun_h,
+         const Mil &gun_dir, const Mil &gun_dir_main, const Mil &gun_dir_res, const Mil &gun_dir_night,
+         const std::string &name, const std::string &description, const ChargeInventory &charges,
          const std::vector<std::tuple<Mil, Mil, int, int>> &covers) {
     if (!isValidX(gun_x)) {
         throw std::runtime_error("invalid gun x");
@@ -70,14 +65,14 @@ Gun::Gun(const double &gun_x, const double &gun_y, const double &gun_h,
         throw std::runtime_error("gun description too long");
     }
     this->gun_charges = charges;
-    this->gun_covers = covers;
+    this->gun_covers.assign(covers);
     this->gun_description = description;
     this->gun_dir = gun_dir;
     this->gun_dir_main = gun_dir_main;
     this->gun_dir_res = gun_dir_res;
     this->gun_dir_night = gun_dir_night;
     this->gun_h = gun_h;
-    this->gun_ID = generateUniqueID();
+    this->gun_ID = id;
 }
 
 Gun::Gun(const double &gun_x, const double &gun_y, const double &gun_h,
@@ -93,14 +88,6 @@ Gun::Gun(const double &gun_x, const double &gun_y, const double &gun_h,
     if (!isValidH(gun_h)) {
         throw std::runtime_error("invalid gun h");
     }
-    gun_charges = {
-            {lt_full,    0},
-            {lt_reduced, 0},
-            {lt_1st,     0},
-            {lt_2nd,     0},
-            {lt_3rd,     0},
-            {lt_4th,     0}
-    };
     this->gun_covers.clear();
     this->gun_h = gun_h;
     this->gun_dir = gun_dir;
@@ -133,14 +120,6 @@ Gun::Gun(const double &gun_x, const double &gun_y, const double &gun_h,
     if (description.size() > 1000) {
         throw std::runtime_error("gun description too long");
     }
-    gun_charges = {
-            {lt_full,    0},
-            {lt_reduced, 0},
-            {lt_1st,     0},
-            {lt_2nd,     0},
-            {lt_3rd,     0},
-            {lt_4th,     0}
-    };
     this->gun_covers.clear();
     this->gun_description = description;
     this->gun_dir = 0;
@@ -164,66 +143,84 @@ Gun::Gun() {
     this->gun_dir_night = 0;
     this->gun_name = "no_name";
     this->gun_description = "no_description";
-    gun_charges = {
-            {lt_full,    0},
-            {lt_reduced, 0},
-            {lt_1st,     0},
-            {lt_2nd,     0},
-            {lt_3rd,     0},
-            {lt_4th,     0}
-    };
     this->gun_covers.clear();
 }
 
 void Gun::addTarget(Target &tgt) {
-    charge_type charge = determineChargeType(
-            static_cast<int>(calcDistance(tgt.getTargetX(), tgt.getTargetY(), this->getGunX(), this->getGunY())),
-            calcAbsAngleMil(tgt.getTargetX(), tgt.getTargetY(), this->getGunX(), this->getGunY()),
-            this->getCovers(), this->getCharges());
+    TargetGeometry geometry = solveGeometry(*this, tgt);
+    charge_type charge = selectChargeType(static_cast<int>(geometry.ge_distance), Mil(geometry.ge_azimuth));
     this->addTarget(tgt, charge);
 }
 
 void Gun::addTarget(Target &tgt, charge_type charge) {
-    std::shared_ptr<Target> tgt_ptr(new Target(tgt));
-    Gun &gun_ptr = *this;
-    GunTargetParameters params(tgt_ptr, gun_ptr, charge);
-    if (gun_target_parameters[this->getGunID()].empty()) {
-        std::unordered_map<unsigned int, GunTargetParameters> param_map;
-        param_map.insert(std::make_pair(tgt.getTargetID(), params));
-        gun_target_parameters[this->getGunID()] = param_map;
-    } else {
-        gun_target_parameters[this->getGunID()].insert(std::make_pair(tgt.getTargetID(), params));
-    }
+    gun_target_parameters.insert(*this, tgt, charge);
 }
 
 void Gun::removeTarget(Target &tgt) {
-    if (gun_target_parameters[this->getGunID()].empty()) {
+    if (gun_target_parameters.countGunRows(this->getGunID()) == 0) {
         throw std::runtime_error("can't remove: no targets are bound to the gun");
     }
-    if (gun_target_parameters[this->getGunID()].find(tgt.getTargetID()) ==
-        gun_target_parameters[this->getGunID()].end()) {
-        throw std::runtime_error("can't remove: target not bound to a gun");
-    }
-    gun_target_parameters[this->getGunID()].erase(tgt.getTargetID());
+    gun_target_parameters.erase(this->getGunID(), tgt.getTargetID());
 }
 
 void Gun::removeAllTargets() {
-    if (gun_target_parameters[this->getGunID()].empty()) {
+    if (gun_target_parameters.countGunRows(this->getGunID()) == 0) {
         throw std::runtime_error("can't remove: no targets are bound to the gun");
     }
-    gun_target_parameters[this->getGunID()].clear();
+    gun_target_parameters.eraseGun(this->getGunID());
 }
 
 void Gun::updateTargetParameters() {
-    if (gun_target_parameters.find(this->getGunID()) != gun_target_parameters.end()) {
-        for (auto &p: gun_target_parameters.at(this->getGunID())) {
-            p.second.updateParameters();
-        }
+    gun_target_parameters.updateGun(*this);
+}
+
+// charge type for firing at the distance in the direction, same as determineChargeType() with the gun covers and charges;
+// the choice depends only on the distance, the first cover crossed by the direction of fire and the charge types in stock,
+// so it is remembered for these three until covers or charges of the gun change or GUN_CHARGE_CACHE_SIZE are remembered
+charge_type Gun::selectChargeType(int distance, const Mil &absolute_angle) {
+    auto cover_index = static_cast<u_int64_t>(this->gun_covers.find(absolute_angle) + 1);
+    u_int16_t stock_mask = this->gun_charges.getStockMask();
+    u_int64_t key = static_cast<u_int32_t>(distance) | (cover_index << 32) | (static_cast<u_int64_t>(stock_mask) << 48);
+    if (const charge_type *cached = this->gun_charge_cache.find(key)) {
+        return *cached;
+    }
+    // targets which can't be fired at are not remembered, so the exception is thrown again on every call
+    charge_type charge = determineChargeType(distance, absolute_angle, this->gun_covers, this->gun_charges);
+    this->gun_charge_cache.insert(key, charge);
+    return charge;
+}
+
+// the assigned gun has other covers or charges, so its cache is emptied rather than taken over
+ChargeTypeCache &ChargeTypeCache::operator=(const ChargeTypeCache &other) {
+    if (this != &other) {
+        this->cc_charges.clear();
+    }
+    return *this;
+}
+
+const charge_type *ChargeTypeCache::find(u_int64_t key) const {
+    auto it = this->cc_charges.find(key);
+    return it == this->cc_charges.end() ? nullptr : &it->second;
+}
+
+void ChargeTypeCache::insert(u_int64_t key, charge_type charge) {
+    if (this->cc_charges.size() >= GUN_CHARGE_CACHE_SIZE) {
+        this->cc_charges.clear();
     }
+    this->cc_charges.emplace(key, charge);
+}
+
+void ChargeTypeCache::clear() {
+    this->cc_charges.clear();
+}
+
+void Gun::invalidateChargeCache() {
+    this->gun_charge_cache.clear();
 }
 
 void Gun::setCovers(const std::vector<std::tuple<Mil, Mil, int, int>> &covers) {
-    this->gun_covers = covers;
+    this->gun_covers.assign(covers);
+    invalidateChargeCache();
 }
 
 void Gun::addCover(const Mil &direction, int cover_d, int cover_h, int cover_w) {
@@ -232,11 +229,12 @@ void Gun::addCover(const Mil &direction, int cover_d, int cover_h, int cover_w)
     }
     auto d = static_cast<double>(cover_d);
     auto w = static_cast<double>(cover_w);
-    double side = sqrt(d * d + (w / 2) * (w / 2));
-    double angle = asin(w / (2 * side));
-    Mil dir_left = direction - Mil(angle);
-    Mil dir_right = direction + Mil(angle);
-    this->gun_covers.emplace_back(dir_left, dir_right, cover_d, cover_h);
+    // half of the angle covered by the obstacle, asin(w / 2 / side) = atan(w / 2 / d)
+    Mil angle(atanMil(w / 2 / d));
+    Mil dir_left = direction - angle;
+    Mil dir_right = direction + angle;
+    this->gun_covers.add({dir_left, dir_right, cover_d, cover_h});
+    invalidateChargeCache();
 }
 
 void Gun::addCover(const Mil &dir_left, const Mil &dir_right, const Mil &elev, double dist) {
@@ -245,11 +243,13 @@ void Gun::addCover(const Mil &dir_left, const Mil &dir_right, const Mil &elev, d
     if ((cover_d < 100 || cover_d > 1000) || (cover_h < 5 || cover_h > 50)) {
         throw std::runtime_error("invalid cover distance/height");
     }
-    this->gun_covers.emplace_back(dir_left, dir_right, cover_d, cover_h);
+    this->gun_covers.add({dir_left, dir_right, cover_d, cover_h});
+    invalidateChargeCache();
 }
 
-void Gun::setCharges(const std::map<charge_type, unsigned int> &charges) {
+void Gun::setCharges(const ChargeInventory &charges) {
     this->gun_charges = charges;
+    invalidateChargeCache();
 }
 
 void Gun::addCharge(charge_type charge, int quantity) {
@@ -257,6 +257,7 @@ void Gun::addCharge(charge_type charge, int quantity) {
         throw std::runtime_error("invalid charge type (mortar-fire subdivisions not allowed)");
     }
     this->gun_charges[charge] += quantity;
+    invalidateChargeCache();
 }
 
 void Gun::subCharge(charge_type charge, int quantity) {
@@ -267,6 +268,7 @@ void Gun::subCharge(charge_type charge, int quantity) {
         throw std::runtime_error("cannot subtract quantity greater than number of remaining charges");
     }
     this->gun_charges[charge] -= quantity;
+    invalidateChargeCache();
 }
 
 void Gun::setGunX(const double &val) {
@@ -275,7 +277,8 @@ void Gun::setGunX(const double &val) {
     }
     this->gun_x = val;
     this->gun_covers.clear();
-    updateTargetParameters();
+    invalidateChargeCache();
+    gun_target_parameters.invalidateGun(*this, fd_position);
 }
 
 void Gun::setGunY(const double &val) {
@@ -284,7 +287,8 @@ void Gun::setGunY(const double &val) {
     }
     this->gun_y = val;
     this->gun_covers.clear();
-    updateTargetParameters();
+    invalidateChargeCache();
+    gun_target_parameters.invalidateGun(*this, fd_position);
 
 }
 
@@ -294,36 +298,37 @@ void Gun::setGunH(const double &val) {
     }
     this->gun_h = val;
     this->gun_covers.clear();
-    updateTargetParameters();
+    invalidateChargeCache();
+    gun_target_parameters.invalidateGun(*this, fd_position);
 }
 
 void Gun::setAbsoluteDirection(const Mil &dir) {
     this->gun_dir = dir;
-    updateTargetParameters();
+    gun_target_parameters.invalidateGun(*this, fd_direction);
 }
 
 void Gun::setAbsoluteDirection(double dir) {
     Mil dir_mil(dir);
     this->gun_dir = dir_mil;
-    updateTargetParameters();
+    gun_target_parameters.invalidateGun(*this, fd_direction);
 }
 
 void Gun::setDirection(const Mil &dir_main) {
     this->gun_dir_main = dir_main;
-    updateTargetParameters();
+    gun_target_parameters.invalidateGun(*this, fd_direction);
 }
 
 void Gun::setDirection(const Mil &dir_main, const Mil &dir_res) {
     this->gun_dir_main = dir_main;
     this->gun_dir_res = dir_res;
-    updateTargetParameters();
+    gun_target_parameters.invalidateGun(*this, fd_direction);
 }
 
 void Gun::setDirection(const Mil &dir_main, const Mil &dir_res, const Mil &dir_night) {
     this->gun_dir_main = dir_main;
     this->gun_dir_res = dir_res;
     this->gun_dir_night = dir_night;
-    updateTargetParameters();
+    gun_target_parameters.invalidateGun(*this, fd_direction);
 }
 
 void Gun::setGunName(const std::string &name) {
@@ -381,25 +386,27 @@ std::string Gun::getGunDescription() const {
 }
 
 unsigned int Gun::getTargetNumber() const {
-    if (gun_target_parameters.find(this->getGunID()) != gun_target_parameters.end()) {
-        return gun_target_parameters[this->getGunID()].size();
-    } else return 0;
+    return gun_target_parameters.countGunRows(this->getGunID());
 }
 
-std::map<charge_type, unsigned int> Gun::getCharges() const {
+const ChargeInventory &Gun::getCharges() const {
     return this->gun_charges;
 }
 
-std::vector<std::tuple<Mil, Mil, int, int>> Gun::getCovers() const {
+const std::vector<std::tuple<Mil, Mil, int, int>> &Gun::getCovers() const {
+    return this->gun_covers.getCovers();
+}
+
+const CoverIndex &Gun::getCoverIndex() const {
     return this->gun_covers;
 }
 
 std::unordered_map<unsigned int, GunTargetParameters> Gun::getTargets() const {
-    if (gun_target_parameters.find(this->getGunID()) != gun_target_parameters.end()) {
-        return gun_target_parameters[this->getGunID()];
-    } else {
+    auto targets = gun_target_parameters.getGunParameters(this->getGunID());
+    if (targets.empty()) {
         std::cout << "GUN " << std::setw(8) << std::setfill('0') << this->getGunID() << " HAS NO TARGETS";
     }
+    return targets;
 }
 
 void Gun::printGunInfo() {
@@ -415,11 +422,14 @@ void Gun::printGunInfo() {
     std::cout << "Number of targets: " << this->getTargetNumber() << "\n";
 }
 
+// prints the targets in ascending order of ID as they are in the current snapshot of the fire missions
 void Gun::printTargetParameters(bool adv_mode) {
-    if (gun_target_parameters.find(this->getGunID()) != gun_target_parameters.end()) {
+    auto parameters = gun_target_parameters.getGunParameters(this->getGunID());
+    std::map<unsigned int, GunTargetParameters> targets(parameters.begin(), parameters.end());
+    if (!targets.empty()) {
         std::cout << "PRINTING TARGETS FOR " << this->gun_name << ":\n\n";
-        for (auto &tp: gun_target_parameters[this->getGunID()]) {
-            tp.second.consolePrint(adv_mode);
+        for (auto &target: targets) {
+            target.second.consolePrint(adv_mode);
         }
     } else {
         std::cout << "NOTHING TO PRINT!\n";
@@ -427,44 +437,39 @@ void Gun::printTargetParameters(bool adv_mode) {
 }
 
 
-GunTargetParameters::GunTargetParameters(const std::shared_ptr<Target>& target, Gun &gun, charge_type charge) : tp_gun(gun) {
+GunTargetParameters::GunTargetParameters(const std::shared_ptr<const Target>& target, const Gun &gun, charge_type charge)
+        : tp_gun(std::make_shared<const Gun>(gun)) {
     this->tp_target = target;
-    this->tp_gun = gun;
     this->tp_gun_id = gun.getGunID();
     this->tp_target_id = target->getTargetID();
     this->tp_charge = charge;
-    this->tp_distance = calculateDistance();
-    this->tp_level = calculateLevel();
+    applyGeometry(solveGeometry(*this->tp_gun, *this->tp_target));
     int distance = static_cast<int>(tp_distance);
     this->tp_elevation = getAimChargeType(distance, this->tp_charge);
-    this->tp_azimuth_abs = calculateAngleMil();
-    this->tp_azimuth_turn = calculateTurn();
-    this->tp_azimuth_main = this->tp_gun.getDirectionMain() + this->tp_azimuth_turn;
-    this->tp_azimuth_res = this->tp_gun.getDirectionRes() + this->tp_azimuth_turn;
-    this->tp_azimuth_night = this->tp_gun.getDirectionNight() + this->tp_azimuth_turn;
-    this->tp_ballistic_parameters = getParametersChargeType(distance, this->tp_charge);
+    this->tp_azimuth_main = this->tp_gun->getDirectionMain() + this->tp_azimuth_turn;
+    this->tp_azimuth_res = this->tp_gun->getDirectionRes() + this->tp_azimuth_turn;
+    this->tp_azimuth_night = this->tp_gun->getDirectionNight() + this->tp_azimuth_turn;
+    updateBallisticParameters(distance);
 }
 
-GunTargetParameters::GunTargetParameters(const std::shared_ptr<Target>& target, Gun &gun) : tp_gun(gun) {
+// the charge type is selected by the passed gun, so that its charge cache is filled; the parameters keep a copy of it
+GunTargetParameters::GunTargetParameters(const std::shared_ptr<const Target>& target, Gun &gun)
+        : tp_gun(std::make_shared<const Gun>(gun)) {
     this->tp_target = target;
-    this->tp_gun = gun;
     this->tp_gun_id = gun.getGunID();
     this->tp_target_id = target->getTargetID();
-    this->tp_distance = calculateDistance();
-    this->tp_level = calculateLevel();
-    this->tp_azimuth_turn = calculateTurn();
-    this->tp_azimuth_main = this->tp_gun.getDirectionMain() + this->tp_azimuth_turn;
-    this->tp_azimuth_res = this->tp_gun.getDirectionRes() + this->tp_azimuth_turn;
-    this->tp_azimuth_night = this->tp_gun.getDirectionNight() + this->tp_azimuth_turn;
-    this->tp_charge = determineChargeType(static_cast<int>(this->tp_distance), this->tp_azimuth_abs,
-                                          this->tp_gun.getCovers(), this->tp_gun.getCharges());
+    applyGeometry(solveGeometry(*this->tp_gun, *this->tp_target));
+    this->tp_azimuth_main = this->tp_gun->getDirectionMain() + this->tp_azimuth_turn;
+    this->tp_azimuth_res = this->tp_gun->getDirectionRes() + this->tp_azimuth_turn;
+    this->tp_azimuth_night = this->tp_gun->getDirectionNight() + this->tp_azimuth_turn;
+    this->tp_charge = gun.selectChargeType(static_cast<int>(this->tp_distance), this->tp_azimuth_abs);
     int distance = static_cast<int>(tp_distance);
     this->tp_elevation = getAimChargeType(distance, this->tp_charge);
-    this->tp_azimuth_abs = calculateAngleMil();
-    this->tp_ballistic_parameters = getParametersChargeType(distance, this->tp_charge);
+    updateBallisticParameters(distance);
 }
 
-GunTargetParameters::GunTargetParameters(Gun &gun) : tp_gun(gun) {
+// parameters filled by the caller, e.g. copied out of the fire mission store or loaded from the object store
+GunTargetParameters::GunTargetParameters(std::shared_ptr<const Gun> gun) : tp_gun(std::move(gun)) {
 
 }
 
@@ -474,15 +479,20 @@ void GunTargetParameters::setChargeType(charge_type charge) {
 }
 
 void GunTargetParameters::updateParameters() {
-    this->tp_distance = calculateDistance();
-    this->tp_level = calculateLevel();
+    applyGeometry(solveGeometry(*this->tp_gun, *this->tp_target));
     int distance = static_cast<int>(tp_distance);
     this->tp_elevation = getAimChargeType(distance, this->tp_charge);
-    this->tp_azimuth_turn = calculateTurn();
-    this->tp_azimuth_main = this->tp_gun.getDirectionMain() + this->tp_azimuth_turn;
-    this->tp_azimuth_res = this->tp_gun.getDirectionRes() + this->tp_azimuth_turn;
-    this->tp_azimuth_night = this->tp_gun.getDirectionNight() + this->tp_azimuth_turn;
-    this->tp_ballistic_parameters = getParametersChargeType(distance, this->tp_charge);
+    this->tp_azimuth_main = this->tp_gun->getDirectionMain() + this->tp_azimuth_turn;
+    this->tp_azimuth_res = this->tp_gun->getDirectionRes() + this->tp_azimuth_turn;
+    this->tp_azimuth_night = this->tp_gun->getDirectionNight() + this->tp_azimuth_turn;
+    updateBallisticParameters(distance);
+}
+
+// refills ballistic parameters in place, so that recalculation does not allocate once the vector has grown to full row size
+void GunTargetParameters::updateBallisticParameters(int distance) {
+    this->tp_ballistic_parameters.resize(BALLISTIC_PARAM_COUNT);
+    auto n = getParametersChargeType(distance, this->tp_charge, this->tp_ballistic_parameters);
+    this->tp_ballistic_parameters.resize(n);
 }
 
 void GunTargetParameters::consolePrint(bool adv_mode) {
@@ -552,26 +562,25 @@ void GunTargetParameters::printBallisticParameters(bool lang, bool mode) {
     }
 }
 
+void GunTargetParameters::applyGeometry(const TargetGeometry &geometry) {
+    this->tp_distance = geometry.ge_distance;
+    this->tp_azimuth_abs = Mil(geometry.ge_azimuth);
+    this->tp_azimuth_turn = geometry.ge_turn;
+    this->tp_level = geometry.ge_level;
+}
+
 double GunTargetParameters::calculateDistance() {
-    double dX = this->tp_target->getTargetX() - this->tp_gun.getGunX();
-    double dY = this->tp_target->getTargetY() - this->tp_gun.getGunY();
-    if (dX * dX + dY * dY < 200) {
-        throw std::runtime_error("distance too small");
-    }
-    return sqrt(dX * dX + dY * dY);
+    return calcDistance(this->tp_target->getTargetX(), this->tp_target->getTargetY(),
+                        this->tp_gun->getGunX(), this->tp_gun->getGunY());
 }
 
 Mil GunTargetParameters::calculateLevel() {
-    double dist = this->calculateDistance();
-    double dH = this->tp_target->getTargetH() - this->tp_gun.getGunH();
-    return Mil(atan(dH / dist)) + 3000;
+    return calcLevel(this->calculateDistance(), this->tp_target->getTargetH(), this->tp_gun->getGunH());
 }
 
 int GunTargetParameters::calculateAngleInt() {
-    double dX = this->tp_target->getTargetX() - this->tp_gun.getGunX();
-    double dY = this->tp_target->getTargetY() - this->tp_gun.getGunY();
-    auto target_angle = static_cast<int>(atan(dY / dX) * 3000 / constants::pi) + ((dY > 0) ? 1500 : 4500);
-    return target_angle;
+    return calcAbsAngle(this->tp_target->getTargetX(), this->tp_target->getTargetY(),
+                        this->tp_gun->getGunX(), this->tp_gun->getGunY());
 }
 
 Mil GunTargetParameters::calculateAngleMil() {
@@ -579,11 +588,7 @@ Mil GunTargetParameters::calculateAngleMil() {
 }
 
 int GunTargetParameters::calculateTurn() {
-    int dir = this->tp_gun.getDirectionAbs().getFirst() * 100 + this->tp_gun.getDirectionAbs().getSecond();
-    int turn = dir - calculateAngleInt();
-    if (turn > 3000) turn -= 6000;
-    if (turn < -3000) turn += 6000;
-    return turn;
+    return calcTurn(this->tp_gun->getDirectionAbs(), calculateAngleInt());
 }
 
 int GunTargetParameters::getAzimuthTurn() const {
@@ -622,11 +627,11 @@ double GunTargetParameters::getDistance() const {
     return this->tp_distance;
 }
 
-Gun &GunTargetParameters::getGunReference() const {
-    return this->tp_gun;
+const Gun &GunTargetParameters::getGunReference() const {
+    return *this->tp_gun;
 }
 
-std::shared_ptr<Target> GunTargetParameters::getTargetPointer() const {
+std::shared_ptr<const Target> GunTargetParameters::getTargetPointer() const {
     return this->tp_target;
 }
 
@@ -643,8 +648,9 @@ unsigned int GunTargetParameters::getTargetID() const {
 }
 
 void GunTargetParameters::setTarget(unsigned int target_id) {
-    if(target_map.find(target_id)!=target_map.end()) {
-       this->tp_target = std::make_shared<Target>(target_map.at(target_id));
+    if(auto target = target_map.find(target_id)) {
+       this->tp_target = std::move(target);
+       this->tp_target_id = target_id;
     }
     else {
         throw std::runtime_error("can't manually set target for parameters object: no such target");
@@ -652,8 +658,9 @@ void GunTargetParameters::setTarget(unsigned int target_id) {
 }
 
 void GunTargetParameters::setGun(unsigned int gun_id) {
-    if(gun_map.find(gun_id)!=gun_map.end()) {
-        this->tp_gun = gun_map.at(gun_id);
+    if(auto gun = gun_map.find(gun_id)) {
+        this->tp_gun = std::move(gun);
+        this->tp_gun_id = gun_id;
     }
     else {
         throw std::runtime_error("can't manually set gun for parameters object: no such gun");
@@ -702,6 +709,12 @@ void GunTargetParameters::setBallisticParameters(const std::vector<double>& ball
 
 
 Target::Target(double tg_x, double tg_y, double tg_h, double tg_front, double tg_depth,
+               const std::string &name, const std::string &description)
+        : Target(generateUniqueID(), tg_x, tg_y, tg_h, tg_front, tg_depth, name, description) {
+}
+
+// target with a given ID, e.g. loaded from the object store; the caller keeps generateUniqueID() past it, see reserveUniqueID()
+Target::Target(unsigned int id, double tg_x, double tg_y, double tg_h, double tg_front, double tg_depth,
                const std::string &name, const std::string &description) {
     if (!isValidX(tg_x)) {
     }
@@ -730,7 +743,7 @@ Target::Target(double tg_x, double tg_y, double tg_h, double tg_front, double tg
     }
     this->tg_description = description;
     this->tg_name = name;
-    this->tg_ID = generateUniqueID();
+    this->tg_ID = id;
 }
 
 Target::Target(double tg_x, double tg_y, double tg_h, double tg_front, double tg_depth) {
@@ -838,11 +851,11 @@ double Target::getTargetDepth() const {
     return tg_depth;
 }
 
-std::string Target::getTargetName() const {
+const std::string &Target::getTargetName() const {
     return this->tg_name;
 }
 
-std::string Target::getTargetDescription() const {
+const std::string &Target::getTargetDescription() const {
     return this->tg_description;
 }
 
@@ -864,26 +877,17 @@ void Target::setTargetDescription(const std::string &description) {
     this->tg_name = description;
 }
 
+// only the rows of guns bound to the target are recalculated, they are found through the target index of the store
 void Target::updateBoundGunParameters() {
-    for (auto &gun_params_pair: gun_target_parameters) {
-        for (auto &tgt_param_pair: gun_params_pair.second) {
-            if (tgt_param_pair.first == this->getTargetID()) {
-                tgt_param_pair.second.updateParameters();
-            }
-        }
-    }
+    gun_target_parameters.updateTarget(*this);
+}
+
+std::vector<unsigned int> Target::getBoundGunIDs() const {
+    return gun_target_parameters.getBoundGunIDs(this->getTargetID());
 }
 
 std::unordered_map<unsigned int, GunTargetParameters> getAllGunParamsForTarget(Target &t) {
-    std::unordered_map<unsigned int, GunTargetParameters> all_params_for_target;
-    for (const auto &gun_params_pair: gun_target_parameters) {
-        for (const auto &tgt_param_pair: gun_params_pair.second) {
-            if (tgt_param_pair.first == t.getTargetID()) {
-                all_params_for_target.insert(std::make_pair(gun_params_pair.first, tgt_param_pair.second));
-            }
-        }
-    }
-    return all_params_for_target;
+    return gun_target_parameters.getTargetParameters(t.getTargetID());
 }
 
 int calcAbsAngle(double tg_x, double tg_y, double gun_x, double gun_y) {
@@ -897,11 +901,111 @@ Mil calcAbsAngleMil(double tg_x, double tg_y, double gun_x, double gun_y) {
     return Mil(calcAbsAngle(tg_x, tg_y, gun_x, gun_y));
 }
 
+// minimum squared distance between a gun and a target
+static constexpr double MIN_DISTANCE_SQUARED = 200;
+
 double calcDistance(double tg_x, double tg_y, double gun_x, double gun_y) {
     double dX = tg_x - gun_x;
     double dY = tg_y - gun_y;
-    if (dX * dX + dY * dY < 200) {
+    if (dX * dX + dY * dY < MIN_DISTANCE_SQUARED) {
         throw std::runtime_error("distance too small");
     }
     return sqrt(dX * dX + dY * dY);
-}
\ No newline at end of file
+}
+
+Mil calcLevel(double distance, double tg_h, double gun_h) {
+    double dH = tg_h - gun_h;
+    return Mil(atanMil(dH / distance) + 3000);
+}
+
+int calcTurn(const Mil &gun_dir, int target_angle) {
+    int dir = gun_dir.toInt();
+    int turn = dir - target_angle;
+    if (turn > 3000) turn -= 6000;
+    if (turn < -3000) turn += 6000;
+    return turn;
+}
+
+// the expressions are those of calcDistance(), calcAbsAngle() and calcLevel(), evaluated once for all of them
+static TargetGeometry solveDeltas(double dX, double dY, double dH, int gun_dir) {
+    TargetGeometry geometry{};
+    double squared = dX * dX + dY * dY;
+    geometry.ge_distance = sqrt(squared);
+    geometry.ge_azimuth = static_cast<int>(atan(dY / dX) * 3000 / constants::pi) + ((dY > 0) ? 1500 : 4500);
+    geometry.ge_turn = gun_dir - geometry.ge_azimuth;
+    if (geometry.ge_turn > 3000) geometry.ge_turn -= 6000;
+    if (geometry.ge_turn < -3000) geometry.ge_turn += 6000;
+    geometry.ge_level = Mil(atanMil(dH / geometry.ge_distance) + 3000);
+    return geometry;
+}
+
+TargetGeometry solveGeometry(double gun_x, double gun_y, double gun_h, const Mil &gun_dir,
+                             double tg_x, double tg_y, double tg_h) {
+    double dX = tg_x - gun_x;
+    double dY = tg_y - gun_y;
+    if (dX * dX + dY * dY < MIN_DISTANCE_SQUARED) {
+        throw std::runtime_error("distance too small");
+    }
+    return solveDeltas(dX, dY, tg_h - gun_h, gun_dir.toInt());
+}
+
+TargetGeometry solveGeometry(const Gun &gun, const Target &target) {
+    return solveGeometry(gun.getGunX(), gun.getGunY(), gun.getGunH(), gun.getDirectionAbs(),
+                         target.getTargetX(), target.getTargetY(), target.getTargetH());
+}
+
+// true if the truncation of the angle given by the geometry kernel may differ from the truncation of the exact angle
+static bool nearWholeMil(double angle) {
+    return std::fabs(angle - std::nearbyint(angle)) <= GEOMETRY_KERNEL_ERROR;
+}
+
+void solveGeometryBatch(const Gun &gun, std::span<const double> tg_x, std::span<const double> tg_y,
+                        std::span<const double> tg_h, GeometryBatch &result) {
+    if (tg_y.size() != tg_x.size() || tg_h.size() != tg_x.size()) {
+        throw std::runtime_error("can't solve geometry: coordinate columns differ in size");
+    }
+    std::size_t n = tg_x.size();
+    result.gb_distance.resize(n);
+    result.gb_azimuth.resize(n);
+    result.gb_turn.resize(n);
+    result.gb_level.resize(n);
+    result.gb_valid.resize(n);
+    result.gb_azimuth_angle.resize(n);
+    result.gb_level_angle.resize(n);
+    double gun_x = gun.getGunX();
+    double gun_y = gun.getGunY();
+    double gun_h = gun.getGunH();
+    Mil dir = gun.getDirectionAbs();
+    int gun_dir = dir.toInt();
+    solveGeometryKernel(gun_x, gun_y, gun_h, tg_x.data(), tg_y.data(), tg_h.data(), result.gb_distance.data(),
+                        result.gb_azimuth_angle.data(), result.gb_level_angle.data(), n);
+    for (std::size_t i = 0; i < n; ++i) {
+        double dX = tg_x[i] - gun_x;
+        double dY = tg_y[i] - gun_y;
+        bool valid = dX * dX + dY * dY >= MIN_DISTANCE_SQUARED;
+        result.gb_valid[i] = valid;
+        if (!valid) {
+            result.gb_distance[i] = 0;
+            result.gb_azimuth[i] = 0;
+            result.gb_turn[i] = 0;
+            result.gb_level[i] = Mil();
+            continue;
+        }
+        double azimuth = result.gb_azimuth_angle[i];
+        double level = result.gb_level_angle[i];
+        if (nearWholeMil(azimuth) || nearWholeMil(level)) {
+            TargetGeometry geometry = solveDeltas(dX, dY, tg_h[i] - gun_h, gun_dir);
+            result.gb_azimuth[i] = geometry.ge_azimuth;
+            result.gb_turn[i] = geometry.ge_turn;
+            result.gb_level[i] = geometry.ge_level;
+            continue;
+        }
+        int angle = static_cast<int>(azimuth) + ((dY > 0) ? 1500 : 4500);
+        int turn = gun_dir - angle;
+        if (turn > 3000) turn -= 6000;
+        if (turn < -3000) turn += 6000;
+        result.gb_azimuth[i] = angle;
+        result.gb_turn[i] = turn;
+        result.gb_level[i] = Mil(static_cast<int>(level) + 3000);
+    }
+}
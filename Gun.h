@@ -3,16 +3,36 @@
 
 #include "dependencies.h"
 #include "Data.h"
+#include "Registry.h"
 
 class Gun;
 class Target;
 class GunTargetParameters;
+struct TargetGeometry;
 
-extern std::unordered_map<unsigned int, std::unordered_map<unsigned int, GunTargetParameters>> gun_target_parameters;
+// largest number of charge types remembered by a gun (one per distance, cover and stock), the cache is emptied when it
+// is full
+constexpr std::size_t GUN_CHARGE_CACHE_SIZE = 4096;
 
-extern std::unordered_map<unsigned int, Gun> gun_map;
+// charge types already selected by a gun, see Gun::selectChargeType(); a copy starts empty, so that copies of the gun
+// kept by the registry and the fire mission store on every change don't copy the cache, moves keep it
+class ChargeTypeCache {
+private:
+    std::unordered_map<u_int64_t, charge_type> cc_charges;
+public:
+    ChargeTypeCache() = default;
+    ChargeTypeCache(const ChargeTypeCache&) {}
+    ChargeTypeCache(ChargeTypeCache&&) noexcept = default;
+    ChargeTypeCache& operator=(const ChargeTypeCache& other);
+    ChargeTypeCache& operator=(ChargeTypeCache&&) noexcept = default;
+    [[nodiscard]] const charge_type* find(u_int64_t key) const;
+    void insert(u_int64_t key, charge_type charge);
+    void clear();
+};
 
-extern std::unordered_map<unsigned int, Target> target_map;
+extern Registry<Gun> gun_map;
+
+extern Registry<Target> target_map;
 
 std::vector<GunTargetParameters> getGunTargetParameters();
 
@@ -28,12 +48,18 @@ private:
     Mil gun_dir_main;                                       // Mission Azimuth w.r.t. Main Reference Point    (MRP)
     Mil gun_dir_res;                                        // Mission Azimuth w.r.t. Reserve Reference Point (RRP)
     Mil gun_dir_night;                                      // Mission Azimuth w.r.t. Night Reference Point   (NRP)
-    std::map<charge_type, unsigned int> gun_charges;        // List of charges with quantities for each charge type present
-    std::vector<std::tuple<Mil,Mil,int,int>> gun_covers;    // List of terrain covers and obstacles with azimuth borders, distance and height
+    ChargeInventory gun_charges;                            // Quantities of charges for each charge type
+    CoverIndex gun_covers;                                  // Terrain covers and obstacles with azimuth borders, distance and height
+    ChargeTypeCache gun_charge_cache;                       // Charge types already selected, see selectChargeType()
+    void invalidateChargeCache();
 public:
     Gun(const double& gun_x, const double& gun_y, const double& gun_h,
         const Mil& gun_dir, const Mil& gun_dir_main, const Mil& gun_dir_res, const Mil& gun_dir_night,
-        const std::string& name, const std::string& description, const std::map<charge_type, unsigned int>& charges,
+        const std::string& name, const std::string& description, const ChargeInventory& charges,
+        const std::vector<std::tuple<Mil,Mil,int,int>>& covers);
+    Gun(unsigned int id, const double& gun_x, const double& gun_y, const double& gun_h,
+        const Mil& gun_dir, const Mil& gun_dir_main, const Mil& gun_dir_res, const Mil& gun_dir_night,
+        const std::string& name, const std::string& description, const ChargeInventory& charges,
         const std::vector<std::tuple<Mil,Mil,int,int>>& covers);
     Gun(const double& gun_x, const double& gun_y, const double& gun_h,
         const std::string& name, const std::string& description);
@@ -43,7 +69,8 @@ public:
     Gun();
 
     void updateTargetParameters();
-    void setCharges(const std::map<charge_type, unsigned int>& charges);
+    charge_type selectChargeType(int distance, const Mil& absolute_angle);
+    void setCharges(const ChargeInventory& charges);
     void addCharge(charge_type lt, int quantity);
     void subCharge(charge_type lt, int quantity);
     void setCovers(const std::vector<std::tuple<Mil,Mil,int,int>>& covers);
@@ -76,15 +103,17 @@ public:
     [[nodiscard]] unsigned int getTargetNumber() const;
     [[nodiscard]] std::string getGunName() const;
     [[nodiscard]] std::string getGunDescription() const;
-    [[nodiscard]] std::map<charge_type, unsigned int> getCharges() const;
-    [[nodiscard]] std::vector<std::tuple<Mil,Mil,int,int>> getCovers() const;
+    [[nodiscard]] const ChargeInventory& getCharges() const;
+    [[nodiscard]] const std::vector<std::tuple<Mil,Mil,int,int>>& getCovers() const;
+    [[nodiscard]] const CoverIndex& getCoverIndex() const;
     [[nodiscard]] std::unordered_map<unsigned int, GunTargetParameters> getTargets() const;
 };
 
 class GunTargetParameters {
 private:
-    std::shared_ptr<Target> tp_target;              // Shared pointer to the target
-    Gun& tp_gun;                                    // Reference to the gun to which the target is bound
+    friend class FireMissionStore;
+    std::shared_ptr<const Target> tp_target;        // Target as it was when the parameters were calculated
+    std::shared_ptr<const Gun> tp_gun;              // Copy of the gun to which the target is bound
     unsigned int tp_gun_id;                         // Gun ID
     unsigned int tp_target_id;                      // Target ID
     double tp_distance;                             // Target Distance
@@ -98,10 +127,12 @@ private:
     charge_type tp_charge;                          // Charge Type
     std::vector<double> tp_ballistic_parameters;    // Extended Ballistic Parameters for the target
     static void formatPrintParams(const std::vector<double>& params, int i);
+    void updateBallisticParameters(int distance);
+    void applyGeometry(const TargetGeometry& geometry);
 public:
-    GunTargetParameters(const std::shared_ptr<Target>& target, Gun& gun, charge_type charge);
-    GunTargetParameters(const std::shared_ptr<Target>& target, Gun& gun);
-    GunTargetParameters(Gun &gun);
+    GunTargetParameters(const std::shared_ptr<const Target>& target, const Gun& gun, charge_type charge);
+    GunTargetParameters(const std::shared_ptr<const Target>& target, Gun& gun);
+    explicit GunTargetParameters(std::shared_ptr<const Gun> gun);
     void updateParameters();
     void setChargeType(charge_type charge);
     void consolePrint(bool adv_mode);
@@ -126,8 +157,8 @@ public:
     void setCharge(charge_type type);
     void setBallisticParameters(const std::vector<double>& ballistic_params);
 
-    [[nodiscard]] std::shared_ptr<Target> getTargetPointer() const;
-    [[nodiscard]] Gun& getGunReference() const;
+    [[nodiscard]] std::shared_ptr<const Target> getTargetPointer() const;
+    [[nodiscard]] const Gun& getGunReference() const;
     [[nodiscard]] unsigned int getGunID() const;
     [[nodiscard]] unsigned int getTargetID() const;
     [[nodiscard]] int getAzimuthTurn() const;
@@ -154,6 +185,7 @@ private:
     double tg_depth;                    // Target Depth
 public:
     Target(double tg_x, double tg_y, double tg_h, double tg_front, double tg_depth, const std::string& name, const std::string& description);
+    Target(unsigned int id, double tg_x, double tg_y, double tg_h, double tg_front, double tg_depth, const std::string& name, const std::string& description);
     Target(double tg_x, double tg_y, double tg_h, double tg_front, double tg_depth);
     Target(double tg_x, double tg_y, double tg_h);
     void setTargetX(const int& val);
@@ -167,11 +199,12 @@ public:
     [[nodiscard]] double getTargetX() const;
     [[nodiscard]] double getTargetY() const;
     [[nodiscard]] double getTargetH() const;
-    [[nodiscard]] std::string getTargetName() const;
-    [[nodiscard]] std::string getTargetDescription() const;
+    [[nodiscard]] const std::string& getTargetName() const;
+    [[nodiscard]] const std::string& getTargetDescription() const;
     [[nodiscard]] unsigned int getTargetID() const;
     [[nodiscard]] double getTargetFront() const;
     [[nodiscard]] double getTargetDepth() const;
+    [[nodiscard]] std::vector<unsigned int> getBoundGunIDs() const;
 };
 
 int calcAbsAngle(double tg_x, double tg_y, double gun_x, double gun_y);
@@ -180,6 +213,42 @@ Mil calcAbsAngleMil(double tg_x, double tg_y, double gun_x, double gun_y);
 
 double calcDistance(double tg_x, double tg_y, double gun_x, double gun_y);
 
+Mil calcLevel(double distance, double tg_h, double gun_h);
+
+int calcTurn(const Mil& gun_dir, int target_angle);
+
+// geometry of a target w.r.t. a gun, see solveGeometry()
+struct TargetGeometry {
+    double ge_distance;                                     // Target Distance
+    int ge_azimuth;                                         // Target Azimuth w.r.t. True South in Mil, as calcAbsAngle()
+    int ge_turn;                                            // Azimuth Correction w.r.t. Gun Direction, as calcTurn()
+    Mil ge_level;                                           // Level, as calcLevel()
+};
+
+// distance, azimuth, turn and level of the target from one set of coordinate differences, the results are the same
+// as of calcDistance(), calcAbsAngle(), calcTurn() and calcLevel(); throws if the target is too close to the gun
+TargetGeometry solveGeometry(double gun_x, double gun_y, double gun_h, const Mil& gun_dir,
+                             double tg_x, double tg_y, double tg_h);
+
+TargetGeometry solveGeometry(const Gun& gun, const Target& target);
+
+// geometry of many targets w.r.t. one gun kept column by column, i-th element of every column belongs to i-th target
+struct GeometryBatch {
+    std::vector<double> gb_distance;                        // Target Distance
+    std::vector<int> gb_azimuth;                            // Target Azimuth w.r.t. True South in Mil
+    std::vector<int> gb_turn;                               // Azimuth Correction w.r.t. Gun Direction
+    std::vector<Mil> gb_level;                              // Level
+    std::vector<u_int8_t> gb_valid;                         // 0 if the target is too close to the gun (other columns are then 0)
+    std::vector<double> gb_azimuth_angle;                   // Target Azimuth angle in Mil before truncation, see GeometryKernel.h
+    std::vector<double> gb_level_angle;                     // Level angle in Mil before truncation, see GeometryKernel.h
+};
+
+// same as solveGeometry() for targets given by coordinate columns, reuses buffers of the result;
+// targets too close to the gun are marked invalid instead of throwing;
+// distances and angles are calculated by the SIMD geometry kernel, targets with an angle within the kernel error of a
+// whole Mil are recalculated exactly, so that the results are always the same as of solveGeometry()
+void solveGeometryBatch(const Gun& gun, std::span<const double> tg_x, std::span<const double> tg_y,
+                        std::span<const double> tg_h, GeometryBatch& result);
 
 std::unordered_map<unsigned int, GunTargetParameters> getAllGunParamsForTarget(Target& t);
 
@@ -0,0 +1,84 @@
+#include "InterpolationKernel.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define ACE_X86_KERNELS
+#endif
+
+void interpolateParametersScalar(const double *low, const double *high, int a, int b, int c, double *out, std::size_t n) {
+    for (std::size_t k = 0; k < n; ++k) {
+        out[k] = (high[k] - low[k]) * (c - a) / (b - a) + low[k];
+    }
+}
+
+#ifdef ACE_X86_KERNELS
+
+__attribute__((target("sse2")))
+void interpolateParametersSSE2(const double *low, const double *high, int a, int b, int c, double *out, std::size_t n) {
+    const __m128d num = _mm_set1_pd(static_cast<double>(c - a));
+    const __m128d den = _mm_set1_pd(static_cast<double>(b - a));
+    std::size_t k = 0;
+    for (; k + 2 <= n; k += 2) {
+        __m128d lo = _mm_loadu_pd(low + k);
+        __m128d hi = _mm_loadu_pd(high + k);
+        __m128d res = _mm_add_pd(_mm_div_pd(_mm_mul_pd(_mm_sub_pd(hi, lo), num), den), lo);
+        _mm_storeu_pd(out + k, res);
+    }
+    interpolateParametersScalar(low + k, high + k, a, b, c, out + k, n - k);
+}
+
+__attribute__((target("avx2")))
+void interpolateParametersAVX2(const double *low, const double *high, int a, int b, int c, double *out, std::size_t n) {
+    const __m256d num = _mm256_set1_pd(static_cast<double>(c - a));
+    const __m256d den = _mm256_set1_pd(static_cast<double>(b - a));
+    std::size_t k = 0;
+    for (; k + 4 <= n; k += 4) {
+        __m256d lo = _mm256_loadu_pd(low + k);
+        __m256d hi = _mm256_loadu_pd(high + k);
+        __m256d res = _mm256_add_pd(_mm256_div_pd(_mm256_mul_pd(_mm256_sub_pd(hi, lo), num), den), lo);
+        _mm256_storeu_pd(out + k, res);
+    }
+    interpolateParametersSSE2(low + k, high + k, a, b, c, out + k, n - k);
+}
+
+#else
+
+void interpolateParametersSSE2(const double *low, const double *high, int a, int b, int c, double *out, std::size_t n) {
+    interpolateParametersScalar(low, high, a, b, c, out, n);
+}
+
+void interpolateParametersAVX2(const double *low, const double *high, int a, int b, int c, double *out, std::size_t n) {
+    interpolateParametersScalar(low, high, a, b, c, out, n);
+}
+
+#endif
+
+using InterpolationKernel = void (*)(const double *, const double *, int, int, int, double *, std::size_t);
+
+static InterpolationKernel chooseInterpolationKernel() {
+#ifdef ACE_X86_KERNELS
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) {
+        return interpolateParametersAVX2;
+    }
+    return interpolateParametersSSE2;
+#else
+    return interpolateParametersScalar;
+#endif
+}
+
+// the kernel is picked by the first call, which may come from a static initializer of another file
+static InterpolationKernel interpolationKernel() {
+    static const InterpolationKernel kernel = chooseInterpolationKernel();
+    return kernel;
+}
+
+void interpolateParameters(const double *low, const double *high, int a, int b, int c, double *out, std::size_t n) {
+    interpolationKernel()(low, high, a, b, c, out, n);
+}
+
+std::string getInterpolationKernelName() {
+    if (interpolationKernel() == interpolateParametersAVX2) return "avx2";
+    if (interpolationKernel() == interpolateParametersSSE2) return "sse2";
+    return "scalar";
+}
@@ -0,0 +1,23 @@
+#ifndef ACE_ARTILLERY1_0_INTERPOLATIONKERNEL_H
+#define ACE_ARTILLERY1_0_INTERPOLATIONKERNEL_H
+
+#include "dependencies.h"
+
+// number of doubles processed by one instruction of the widest supported kernel (AVX2),
+// rows padded to a multiple of it are interpolated without a scalar tail
+constexpr std::size_t SIMD_DOUBLE_WIDTH = 4;
+
+// linear interpolation of n values between rows for distances a and b at distance c:
+// out[k] = (high[k] - low[k]) * (c - a) / (b - a) + low[k]
+// the operations are done in the same order as in the scalar formula, so every kernel gives bit-identical results
+void interpolateParametersScalar(const double* low, const double* high, int a, int b, int c, double* out, std::size_t n);
+void interpolateParametersSSE2(const double* low, const double* high, int a, int b, int c, double* out, std::size_t n);
+void interpolateParametersAVX2(const double* low, const double* high, int a, int b, int c, double* out, std::size_t n);
+
+// kernel chosen once at runtime: AVX2 if the processor supports it, SSE2 on other x86 processors, scalar otherwise
+void interpolateParameters(const double* low, const double* high, int a, int b, int c, double* out, std::size_t n);
+
+// name of the kernel chosen by interpolateParameters() ("avx2", "sse2" or "scalar")
+std::string getInterpolationKernelName();
+
+#endif //ACE_ARTILLERY1_0_INTERPOLATIONKERNEL_H
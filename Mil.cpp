@@ -1,208 +1,119 @@
 #include "Mil.h"
+#include "dependencies.h"
+#include <array>
 // USSR/Russian/Armenian Mil-radian angle measurement unit used in artillery, anti-air defence etc.
 // 6000 Mils = 360 Degrees
 
-bool isValidMilString(const std::string& s) {
-    return !(s.size() != 5 || s[2] != '-' ||
-        stoi(s.substr(0, 2)) < 0 || stoi(s.substr(0, 2)) > 59 ||
-        stoi(s.substr(3, 2)) < 0 || stoi(s.substr(3, 2)) > 99);
-}
-
-Mil::Mil() {
-    this->first = 0;
-    this->second = 0;
-}
-
-Mil::Mil(const Mil &m) {
-    this->first = m.first;
-    this->second = m.second;
-}
+// number of Mil in a quarter of the full circle
+static constexpr int QUARTER_CIRCLE = 1500;
 
-Mil::Mil(double angle) {
-    int mil = (int) (angle * 3000 / constants::pi) % 6000;
-    if (mil < 0) mil += 6000;
-    first = mil / 100;
-    second = mil % 100;
-}
-
-Mil::Mil(int first, int second) {
-    this->first = first;
-    this->second = second;
-    this->first += this->second / 100;
-    this->second = this->second % 100;
-    this->first = this->first % 60;
-}
-
-Mil::Mil(int whole) {
-    this->first = whole / 100;
-    this->second = whole % 100;
-}
-
-Mil::Mil(const std::string& angle) {
-    if(!isValidMilString(angle)) {
-        throw std::runtime_error("invalid mil string");
+// Taylor series of sin and cos, for |x| <= pi / 4 the terms used reach far below the precision of double
+static constexpr double seriesSin(double x) {
+    double term = x;
+    double sum = x;
+    for (int n = 1; n < 12; ++n) {
+        term *= -x * x / ((2 * n) * (2 * n + 1));
+        sum += term;
     }
-    this->first = stoi(angle.substr(0,2));
-    this->second = stoi(angle.substr(3,2));
-}
-
-Mil Mil::operator+(const Mil &m) const {
-    int m1 = this->first * 100 + this->second;
-    int m2 = m.first * 100 + m.second;
-    m1 += m2;
-    m1 = m1 % 6000;
-    if (m1 < 0) m1 += 6000;
-    return {m1 / 100, m1 % 100};
-}
-
-Mil Mil::operator+(const std::pair<int, int> &m) const {
-    int m1 = this->first * 100 + this->second;
-    int m2 = m.first * 100 + m.second;
-    m1 += m2;
-    m1 = m1 % 6000;
-    if (m1 < 0) m1 += 6000;
-    return {m1 / 100, m1 % 100};
-}
-
-Mil Mil::operator+(int m) const {
-    int m1 = this->first * 100 + this->second;
-    m1 += m;
-    m1 = m1 % 6000;
-    if (m1 < 0) m1 += 6000;
-    return {m1 / 100, m1 % 100};
-}
-
-Mil &Mil::operator+=(const Mil &m) {
-    int m1 = this->first * 100 + this->second;
-    int m2 = m.first * 100 + m.second;
-    m1 += m2;
-    m1 = m1 % 6000;
-    if (m1 < 0) m1 += 6000;
-    this->first = m1 / 100;
-    this->second = m1 % 100;
-    return *this;
-}
-
-Mil &Mil::operator+=(const std::pair<int, int> &m) {
-    int m1 = this->first * 100 + this->second;
-    int m2 = m.first * 100 + m.second;
-    m1 += m2;
-    m1 = m1 % 6000;
-    if (m1 < 0) m1 += 6000;
-    this->first = m1 / 100;
-    this->second = m1 % 100;
-    return *this;
-}
-
-Mil &Mil::operator+=(int m) {
-    int m1 = this->first * 100 + this->second;
-    m1 += m;
-    m1 = m1 % 6000;
-    if (m1 < 0) m1 += 6000;
-    this->first = m1 / 100;
-    this->second = m1 % 100;
-    return *this;
-}
-
-Mil Mil::operator-(const Mil &m) const {
-    int m1 = this->first * 100 + this->second;
-    int m2 = m.first * 100 + m.second;
-    m1 -= m2;
-    m1 = m1 % 6000;
-    if (m1 < 0) m1 += 6000;
-    return {m1 / 100, m1 % 100};
+    return sum;
 }
 
-Mil Mil::operator-(const std::pair<int, int> &m) const {
-    int m1 = this->first * 100 + this->second;
-    int m2 = m.first * 100 + m.second;
-    m1 -= m2;
-    m1 = m1 % 6000;
-    if (m1 < 0) m1 += 6000;
-    return {m1 / 100, m1 % 100};
-}
-
-Mil Mil::operator-(int m) const {
-    int m1 = this->first * 100 + this->second;
-    m1 -= m;
-    m1 = m1 % 6000;
-    if (m1 < 0) m1 += 6000;
-    return {m1 / 100, m1 % 100};
+static constexpr double seriesCos(double x) {
+    double term = 1;
+    double sum = 1;
+    for (int n = 1; n < 12; ++n) {
+        term *= -x * x / ((2 * n - 1) * (2 * n));
+        sum += term;
+    }
+    return sum;
+}
+
+// sin of every whole Mil from 0 to 5999 and further to 7499, so that cos(m) = sin(m + 1500) is read from the same
+// table; the argument of the series is always reduced to [0, pi / 4]
+static constexpr std::array<double, 6000 + QUARTER_CIRCLE> makeSinTable() {
+    std::array<double, 6000 + QUARTER_CIRCLE> table{};
+    for (int k = 0; k < 6000 + QUARTER_CIRCLE; ++k) {
+        int quadrant = (k / QUARTER_CIRCLE) % 4;
+        int r = k % QUARTER_CIRCLE;
+        double s = r <= QUARTER_CIRCLE / 2 ? seriesSin(r * constants::pi / 3000)
+                                           : seriesCos((QUARTER_CIRCLE - r) * constants::pi / 3000);
+        double c = r <= QUARTER_CIRCLE / 2 ? seriesCos(r * constants::pi / 3000)
+                                           : seriesSin((QUARTER_CIRCLE - r) * constants::pi / 3000);
+        double values[4] = {s, c, -s, -c};
+        table[k] = values[quadrant];
+    }
+    return table;
 }
 
-Mil &Mil::operator-=(const Mil &m) {
-    int m1 = this->first * 100 + this->second;
-    int m2 = m.first * 100 + m.second;
-    m1 -= m2;
-    m1 = m1 % 6000;
-    if (m1 < 0) m1 += 6000;
-    this->first = m1 / 100;
-    this->second = m1 % 100;
-    return *this;
-}
+static constexpr auto mil_sin = makeSinTable();
 
-Mil &Mil::operator-=(const std::pair<int, int> &m) {
-    int m1 = this->first * 100 + this->second;
-    int m2 = m.first * 100 + m.second;
-    m1 -= m2;
-    m1 = m1 % 6000;
-    if (m1 < 0) m1 += 6000;
-    this->first = m1 / 100;
-    this->second = m1 % 100;
-    return *this;
+// tan of every whole Mil of the first quadrant, atanMil() finds the last one not above the ratio
+static constexpr std::array<double, QUARTER_CIRCLE> makeTanTable() {
+    std::array<double, QUARTER_CIRCLE> table{};
+    for (int k = 0; k < QUARTER_CIRCLE; ++k) {
+        table[k] = mil_sin[k] / mil_sin[k + QUARTER_CIRCLE];
+    }
+    return table;
 }
 
-Mil &Mil::operator-=(int m) {
-    int m1 = this->first * 100 + this->second;
-    m1 -= m;
-    m1 = m1 % 6000;
-    if (m1 < 0) m1 += 6000;
-    this->first = m1 / 100;
-    this->second = m1 % 100;
-    return *this;
-}
+static constexpr auto mil_tan = makeTanTable();
 
-Mil &Mil::operator=(const Mil &m) {
-    if (this != &m) {
-        this->first = m.first;
-        this->second = m.second;
+static constexpr bool isUnitCircle() {
+    for (int k = 0; k < 6000; ++k) {
+        double norm = mil_sin[k] * mil_sin[k] + mil_sin[k + QUARTER_CIRCLE] * mil_sin[k + QUARTER_CIRCLE];
+        if (norm - 1 > 1e-15 || 1 - norm > 1e-15) {
+            return false;
+        }
     }
-    return *this;
+    return true;
 }
 
-Mil &Mil::operator=(int m) {
-    if (this->first * 100 + this->second != m) {
-        this->first = m / 100;
-        this->second = m % 100;
+static constexpr bool isAscending() {
+    for (int k = 1; k < QUARTER_CIRCLE; ++k) {
+        if (mil_tan[k] <= mil_tan[k - 1]) {
+            return false;
+        }
     }
-    return *this;
+    return true;
 }
 
-bool Mil::operator!=(const Mil &m) const {
-    return this->first != m.first || this->second != m.second;
-}
+// the tables are checked when they are generated: known angles (30, 45, 90, 180 degrees), sin^2 + cos^2 = 1 for every
+// angle and strictly ascending tangents, so that every ratio belongs to a single Mil
+static_assert(mil_sin[0] == 0 && mil_sin[1500] == 1 && mil_sin[3000 + QUARTER_CIRCLE] == -1);
+static_assert(mil_sin[500] - 0.5 < 1e-16 && 0.5 - mil_sin[500] < 1e-16);
+static_assert(mil_tan[750] - 1 < 1e-15 && 1 - mil_tan[750] < 1e-15);
+static_assert(isUnitCircle() && isAscending());
 
-bool Mil::operator==(const Mil &m) const {
-    return this->first == m.first && this->second == m.second;
+double Mil::sin() const noexcept {
+    return mil_sin[this->mils];
 }
 
-bool Mil::operator>(const Mil &m) const {
-    return this->first * 100 + this->second > m.first * 100 + m.second;
+double Mil::cos() const noexcept {
+    return mil_sin[this->mils + QUARTER_CIRCLE];
 }
 
-bool Mil::operator>=(const Mil &m) const {
-    return this->first * 100 + this->second >= m.first * 100 + m.second;
+int atanMil(double ratio) noexcept {
+    double r = std::fabs(ratio);
+    auto mil = static_cast<int>(std::upper_bound(mil_tan.begin(), mil_tan.end(), r) - mil_tan.begin()) - 1;
+    return ratio < 0 ? -mil : mil;
 }
 
-bool Mil::operator<(const Mil &m) const {
-    return this->first * 100 + this->second < m.first * 100 + m.second;
+bool isValidMilString(const std::string& s) {
+    return !(s.size() != 5 || s[2] != '-' ||
+        stoi(s.substr(0, 2)) < 0 || stoi(s.substr(0, 2)) > 59 ||
+        stoi(s.substr(3, 2)) < 0 || stoi(s.substr(3, 2)) > 99);
 }
 
-bool Mil::operator<=(const Mil &m) const {
-    return this->first * 100 + this->second <= m.first * 100 + m.second;
+Mil::Mil(const std::string& angle) {
+    if(!isValidMilString(angle)) {
+        throw std::runtime_error("invalid mil string");
+    }
+    this->mils = static_cast<std::uint16_t>(stoi(angle.substr(0,2)) * 100 + stoi(angle.substr(3,2)));
 }
 
 Mil::operator std::string() const {
+    int first = getFirst();
+    int second = getSecond();
     std::string s;
     if (first < 10) s += '0';
     s += std::to_string(first);
@@ -212,47 +123,10 @@ Mil::operator std::string() const {
     return s;
 }
 
-void Mil::setFirst(int a) {
-    if (a < 0 || a > 60) {
-        throw std::runtime_error("invalid mil first");
-    }
-    if (a == 60) {
-        a = 0;
-    }
-    this->first = a;
-}
-
-void Mil::setSecond(int a) {
-    if (a < 0 || a > 99) {
-        throw std::runtime_error("invalid mil second");
-    }
-    this->second = a;
-}
-
-int Mil::getFirst() const {
-    return this->first;
-}
-
-int Mil::getSecond() const {
-    return this->second;
-}
-
-int Mil::toInt() const {
-    return this->first * 100 + this->second;
-}
-
-double Mil::toDegrees() const {
-    return static_cast<double>(this->first * 100 + this->second) * 360. / 6000.;
-}
-
-double Mil::toRadians() const {
-    return static_cast<double>(this->first * 100 + this->second) * 2 * constants::pi / 6000.;
-}
-
 // output operator overloading for Mil (mil-radian) class
 std::ostream &operator<<(std::ostream &out, const Mil &m) {
-    out << std::setw(2) << std::setfill('0') << m.first << "-";
-    out << std::setw(2) << std::setfill('0') << m.second;
+    out << std::setw(2) << std::setfill('0') << m.getFirst() << "-";
+    out << std::setw(2) << std::setfill('0') << m.getSecond();
     return out;
 }
 
@@ -264,8 +138,7 @@ std::istream &operator>>(std::istream &in, Mil &m) {
     if ((dash != '-' && dash != '_') || (a < 0 || a > 59) || (b < 0 || b > 99)) {
         throw std::runtime_error("invalid mil input");
     }
-    m.first = a;
-    m.second = b;
+    m.mils = static_cast<std::uint16_t>(a * 100 + b);
     return in;
 }
 
@@ -1,54 +1,105 @@
 #ifndef ACE_ARTILLERY1_0_MIL_H
 #define ACE_ARTILLERY1_0_MIL_H
 
-#include "dependencies.h"
+#include <cstdint>
+#include <iosfwd>
+#include <numbers>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <utility>
 
 // mil-radian class for working with angles (6000 Mil = 360 degrees = 2 * pi radians)
+// the angle is kept as a single count of Mil in [0, 6000), every operation wraps around the full circle;
+// the "XX-YY" form (hundreds of Mil and the remainder) is only produced for input and output
 class Mil {
 private:
-    int first;
-    int second;
+    static constexpr int full_circle = 6000;
+    std::uint16_t mils;
+
+    // wraps any value into [0, 6000)
+    static constexpr std::uint16_t wrap(int mil) noexcept {
+        int r = mil % full_circle;
+        return static_cast<std::uint16_t>(r + (r < 0) * full_circle);
+    }
+
+    // wraps a value in [-6000, 12000), as sums and differences of two angles are, without division
+    static constexpr std::uint16_t wrapNear(int mil) noexcept {
+        mil += (mil < 0) * full_circle;
+        return static_cast<std::uint16_t>(mil - (mil >= full_circle) * full_circle);
+    }
+
 public:
     friend std::ostream &operator<<(std::ostream &out, const Mil &m);
     friend std::istream &operator>>(std::istream &in, Mil &m);
-    Mil();
-    Mil(const Mil &m);
-    explicit Mil(int whole);
-    explicit Mil(double angle);
+    constexpr Mil() noexcept : mils(0) {}
+    constexpr explicit Mil(int whole) noexcept : mils(wrap(whole)) {}
+    // angle in radians, truncated to whole Mil
+    constexpr explicit Mil(double angle) noexcept
+            : mils(wrap(static_cast<int>(angle * 3000 / std::numbers::pi))) {}
     explicit Mil(const std::string& angle);
-    Mil(int first, int second);
-    Mil operator+(const Mil &m) const;
-    Mil operator+(const std::pair<int, int>& m) const;
-    Mil operator+(int m) const;
-    Mil& operator+=(const Mil& m);
-    Mil& operator+=(const std::pair<int,int>& m);
-    Mil& operator+=(int m);
-    Mil operator-(const Mil &m) const;
-    Mil operator-(const std::pair<int, int>& m) const;
-    Mil operator-(int m) const;
-    Mil& operator-=(const Mil& m);
-    Mil& operator-=(const std::pair<int,int>& m);
-    Mil& operator-=(int m);
-    Mil& operator=(const Mil& m);
-    Mil& operator=(int m);
-    bool operator!=(const Mil& m) const;
-    bool operator==(const Mil& m) const;
-    bool operator>(const Mil& m) const;
-    bool operator>=(const Mil& m) const;
-    bool operator<(const Mil& m) const;
-    bool operator<=(const Mil& m) const;
+    constexpr Mil(int first, int second) noexcept : mils(wrap(first * 100 + second)) {}
+
+    constexpr Mil operator+(const Mil &m) const noexcept { return fromMils(wrapNear(this->mils + m.mils)); }
+    constexpr Mil operator+(const std::pair<int, int>& m) const noexcept { return *this + (m.first * 100 + m.second); }
+    constexpr Mil operator+(int m) const noexcept { return fromMils(wrap(this->mils + m)); }
+    constexpr Mil& operator+=(const Mil& m) noexcept { return *this = *this + m; }
+    constexpr Mil& operator+=(const std::pair<int,int>& m) noexcept { return *this = *this + m; }
+    constexpr Mil& operator+=(int m) noexcept { return *this = *this + m; }
+    constexpr Mil operator-(const Mil &m) const noexcept { return fromMils(wrapNear(this->mils - m.mils)); }
+    constexpr Mil operator-(const std::pair<int, int>& m) const noexcept { return *this + -(m.first * 100 + m.second); }
+    constexpr Mil operator-(int m) const noexcept { return fromMils(wrap(this->mils - m)); }
+    constexpr Mil& operator-=(const Mil& m) noexcept { return *this = *this - m; }
+    constexpr Mil& operator-=(const std::pair<int,int>& m) noexcept { return *this = *this - m; }
+    constexpr Mil& operator-=(int m) noexcept { return *this = *this - m; }
+    constexpr Mil& operator=(int m) noexcept {
+        this->mils = wrap(m);
+        return *this;
+    }
+    constexpr bool operator==(const Mil& m) const noexcept = default;
+    constexpr auto operator<=>(const Mil& m) const noexcept = default;
     explicit operator std::string() const;  // conversion operator for working with JSON
-    void setFirst(int a);
-    void setSecond(int a);
-    [[nodiscard]] int getFirst() const;
-    [[nodiscard]] int getSecond() const;
-    [[nodiscard]] double toDegrees() const;
-    [[nodiscard]] double toRadians() const;
-    [[nodiscard]] int toInt() const;
+    constexpr void setFirst(int a) {
+        if (a < 0 || a > 60) {
+            throw std::runtime_error("invalid mil first");
+        }
+        this->mils = wrap(a * 100 + getSecond());
+    }
+    constexpr void setSecond(int a) {
+        if (a < 0 || a > 99) {
+            throw std::runtime_error("invalid mil second");
+        }
+        this->mils = static_cast<std::uint16_t>(getFirst() * 100 + a);
+    }
+    [[nodiscard]] constexpr int getFirst() const noexcept { return this->mils / 100; }
+    [[nodiscard]] constexpr int getSecond() const noexcept { return this->mils % 100; }
+    [[nodiscard]] constexpr double toDegrees() const noexcept { return static_cast<double>(this->mils) * 360. / 6000.; }
+    [[nodiscard]] constexpr double toRadians() const noexcept {
+        return static_cast<double>(this->mils) * 2 * std::numbers::pi / 6000.;
+    }
+    [[nodiscard]] constexpr int toInt() const noexcept { return this->mils; }
+    [[nodiscard]] double sin() const noexcept;  // read from the table of all 6000 angles, see Mil.cpp
+    [[nodiscard]] double cos() const noexcept;
+
+    // angle from a count of Mil already in [0, 6000)
+    static constexpr Mil fromMils(std::uint16_t mils) noexcept {
+        Mil m;
+        m.mils = mils;
+        return m;
+    }
 };
 
+static_assert(sizeof(Mil) == sizeof(std::uint16_t));
+static_assert(std::is_trivially_copyable_v<Mil>);
+static_assert((Mil(5990) + Mil(20)).toInt() == 10 && (Mil(10) - Mil(20)).toInt() == 5990);
+static_assert((Mil(100) + -7000).toInt() == 5100 && Mil(12, 345).toInt() == 1545);
+
 bool isValidMilString(const std::string& s);
 
+// atan(ratio) in whole Mil truncated toward zero, the same as static_cast<int>(atan(ratio) * 3000 / pi) but found
+// in the table of tangents of all angles of the first quadrant; the result lies in (-1500, 1500)
+int atanMil(double ratio) noexcept;
+
 extern std::ostream& operator<<(std::ostream& out, const Mil& m);
 extern std::istream& operator>>(std::istream& in, Mil& m);
 
@@ -0,0 +1,428 @@
+#include "ObjectStore.h"
+#include "TableCache.h"
+
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+const std::string object_store_name = "objects.store";
+
+ObjectStore object_store;
+
+static constexpr char object_store_magic[8] = {'A', 'C', 'E', 'O', 'B', 'J', 0, 0};
+
+static std::uint64_t recordChecksum(ObjectRecordHeader header, const void *payload, std::size_t size) {
+    header.or_checksum = 0;
+    return fnv1aHash(payload, size, fnv1aHash(&header, sizeof(header)));
+}
+
+// appends a record with its checksum to the buffer
+static void appendRecord(std::vector<char> &buffer, object_kind kind, bool erase, std::uint64_t key,
+                         std::uint32_t transaction, const void *payload, std::uint32_t size) {
+    ObjectRecordHeader header{};
+    header.or_magic = OBJECT_RECORD_MAGIC;
+    header.or_kind = kind;
+    header.or_erase = erase;
+    header.or_size = size;
+    header.or_transaction = transaction;
+    header.or_key = key;
+    header.or_checksum = recordChecksum(header, payload, size);
+    auto header_bytes = reinterpret_cast<const char *>(&header);
+    buffer.insert(buffer.end(), header_bytes, header_bytes + sizeof(header));
+    auto payload_bytes = static_cast<const char *>(payload);
+    buffer.insert(buffer.end(), payload_bytes, payload_bytes + size);
+}
+
+// writes the whole buffer at the offset, partial writes are continued
+static bool writeAt(int fd, const char *data, std::size_t size, std::uint64_t offset) {
+    while (size) {
+        ssize_t written = pwrite(fd, data, size, static_cast<off_t>(offset));
+        if (written < 0 && errno == EINTR) {
+            continue;
+        }
+        if (written <= 0) {
+            return false;
+        }
+        data += written;
+        size -= static_cast<std::size_t>(written);
+        offset += static_cast<std::uint64_t>(written);
+    }
+    return true;
+}
+
+static bool readAt(int fd, char *data, std::size_t size, std::uint64_t offset) {
+    while (size) {
+        ssize_t count = pread(fd, data, size, static_cast<off_t>(offset));
+        if (count < 0 && errno == EINTR) {
+            continue;
+        }
+        if (count <= 0) {
+            return false;
+        }
+        data += count;
+        size -= static_cast<std::size_t>(count);
+        offset += static_cast<std::uint64_t>(count);
+    }
+    return true;
+}
+
+// makes a created or renamed file durable, the file itself is synced by the caller
+static void syncDirectory(const std::string &path) {
+    std::string directory = fs::path(path).parent_path().string();
+    int fd = ::open(directory.empty() ? "." : directory.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    if (fd >= 0) {
+        fsync(fd);
+        ::close(fd);
+    }
+}
+
+static std::string makeStoreHeader() {
+    ObjectStoreHeader header{};
+    std::memcpy(header.sh_magic, object_store_magic, sizeof(object_store_magic));
+    header.sh_version = OBJECT_STORE_VERSION;
+    return {reinterpret_cast<const char *>(&header), sizeof(header)};
+}
+
+ObjectStore::~ObjectStore() {
+    closeFile();
+}
+
+// opens the store file, creating it if missing, and builds the index of the committed objects
+void ObjectStore::open(const std::string &path) {
+    std::lock_guard lock(this->os_mutex);
+    closeFile();
+    int fd = ::open(path.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+    if (fd < 0) {
+        throw std::runtime_error("can't open object store");
+    }
+    this->os_fd = fd;
+    this->os_path = path;
+    try {
+        scan();
+    } catch (...) {
+        closeFile();
+        throw;
+    }
+}
+
+void ObjectStore::close() {
+    std::lock_guard lock(this->os_mutex);
+    closeFile();
+}
+
+void ObjectStore::closeFile() {
+    if (this->os_fd >= 0) {
+        ::close(this->os_fd);
+    }
+    this->os_fd = -1;
+    this->os_path.clear();
+    this->os_end = 0;
+    this->os_live_bytes = 0;
+    this->os_transaction = 0;
+    for (auto &index: this->os_index) {
+        index.clear();
+    }
+}
+
+// reads the records one by one and applies every transaction closed by a valid commit record; the first damaged or
+// incomplete record ends the scan and the file is cut off after the last complete transaction
+void ObjectStore::scan() {
+    struct stat st{};
+    if (fstat(this->os_fd, &st) != 0) {
+        throw std::runtime_error("can't read object store");
+    }
+    auto size = static_cast<std::size_t>(st.st_size);
+    if (size < sizeof(ObjectStoreHeader)) {
+        // new file, or a file whose creation did not complete: nothing was ever committed to it
+        std::string header = makeStoreHeader();
+        if (ftruncate(this->os_fd, 0) != 0 || !writeAt(this->os_fd, header.data(), header.size(), 0) ||
+            fsync(this->os_fd) != 0) {
+            throw std::runtime_error("can't create object store");
+        }
+        syncDirectory(this->os_path);
+        this->os_end = header.size();
+        return;
+    }
+    void *mapped = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, this->os_fd, 0);
+    if (mapped == MAP_FAILED) {
+        throw std::runtime_error("can't read object store");
+    }
+    const char *data = static_cast<const char *>(mapped);
+    ObjectStoreHeader header{};
+    std::memcpy(&header, data, sizeof(header));
+    if (std::memcmp(header.sh_magic, object_store_magic, sizeof(object_store_magic)) != 0 ||
+        header.sh_version != OBJECT_STORE_VERSION) {
+        munmap(mapped, size);
+        throw std::runtime_error("object store has unknown format");
+    }
+
+    std::uint64_t offset = sizeof(header);
+    this->os_end = offset;
+    std::vector<PendingRecord> transaction;
+    std::uint32_t transaction_number = 0;
+    while (offset + sizeof(ObjectRecordHeader) <= size) {
+        ObjectRecordHeader record{};
+        std::memcpy(&record, data + offset, sizeof(record));
+        std::uint64_t payload = offset + sizeof(record);
+        if (record.or_magic != OBJECT_RECORD_MAGIC || record.or_kind > ok_commit || payload + record.or_size > size ||
+            record.or_checksum != recordChecksum(record, data + payload, record.or_size)) {
+            break;
+        }
+        if (transaction.empty()) {
+            transaction_number = record.or_transaction;
+        } else if (record.or_transaction != transaction_number) {
+            break;
+        }
+        offset = payload + record.or_size;
+        if (record.or_kind != ok_commit) {
+            transaction.push_back({object_kind(record.or_kind), record.or_erase != 0, record.or_key, payload,
+                                   record.or_size});
+            continue;
+        }
+        if (record.or_key != transaction.size()) {
+            break;
+        }
+        for (const auto &r: transaction) {
+            applyRecord(r.pr_kind, r.pr_erase, r.pr_key, {r.pr_offset, r.pr_size});
+        }
+        transaction.clear();
+        this->os_transaction = record.or_transaction;
+        this->os_end = offset;
+    }
+    munmap(mapped, size);
+    if (this->os_end < size && ftruncate(this->os_fd, static_cast<off_t>(this->os_end)) != 0) {
+        throw std::runtime_error("can't repair object store");
+    }
+}
+
+void ObjectStore::applyRecord(object_kind kind, bool erase, std::uint64_t key, ObjectLocation location) {
+    auto &index = this->os_index[kind];
+    auto it = index.find(key);
+    if (it != index.end()) {
+        this->os_live_bytes -= sizeof(ObjectRecordHeader) + it->second.ol_size;
+        if (erase) {
+            index.erase(it);
+        }
+    }
+    if (!erase) {
+        index.insert_or_assign(key, location);
+        this->os_live_bytes += sizeof(ObjectRecordHeader) + location.ol_size;
+    }
+}
+
+bool ObjectStore::isOpen() const {
+    std::lock_guard lock(this->os_mutex);
+    return this->os_fd >= 0;
+}
+
+std::string ObjectStore::getPath() const {
+    std::lock_guard lock(this->os_mutex);
+    return this->os_path;
+}
+
+// adds the object to the transaction, it is visible to get() after the transaction is committed
+void ObjectTransaction::put(object_kind kind, std::uint64_t key, const json &object) {
+    if (kind >= OBJECT_KIND_COUNT) {
+        throw std::runtime_error("can't store object: invalid kind");
+    }
+    std::vector<std::uint8_t> payload = json::to_cbor(object);
+    if (payload.size() > std::numeric_limits<std::uint32_t>::max()) {
+        throw std::runtime_error("can't store object: object too large");
+    }
+    this->ot_records.push_back({kind, false, key, this->ot_payloads.size(), static_cast<std::uint32_t>(payload.size())});
+    this->ot_payloads.insert(this->ot_payloads.end(), payload.begin(), payload.end());
+}
+
+void ObjectTransaction::erase(object_kind kind, std::uint64_t key) {
+    if (kind >= OBJECT_KIND_COUNT) {
+        throw std::runtime_error("can't erase object: invalid kind");
+    }
+    this->ot_records.push_back({kind, true, key, this->ot_payloads.size(), 0});
+}
+
+void ObjectTransaction::clear() {
+    this->ot_payloads.clear();
+    this->ot_records.clear();
+}
+
+bool ObjectTransaction::empty() const {
+    return this->ot_records.empty();
+}
+
+std::size_t ObjectTransaction::size() const {
+    return this->ot_records.size();
+}
+
+// new empty transaction for the changes of one caller, the store must be open when it is committed
+ObjectTransaction ObjectStore::begin() const {
+    return {};
+}
+
+// appends the records of the transaction and a commit record with a single write and makes them durable with a single
+// fsync, the transaction is then emptied; if either fails, the file is cut back to the previous transaction and
+// the transaction is kept as it was; records get the transaction number only here, so that transactions staged
+// by different callers at the same time are numbered in the order of their commits
+void ObjectStore::commit(ObjectTransaction &transaction) {
+    if (transaction.empty()) {
+        return;
+    }
+    std::lock_guard lock(this->os_mutex);
+    if (this->os_fd < 0) {
+        throw std::runtime_error("can't commit to object store: object store is not open");
+    }
+    std::uint32_t number = this->os_transaction + 1;
+    std::vector<char> buffer;
+    buffer.reserve(transaction.ot_payloads.size() + (transaction.ot_records.size() + 1) * sizeof(ObjectRecordHeader));
+    std::vector<PendingRecord> records;
+    records.reserve(transaction.ot_records.size());
+    for (const auto &r: transaction.ot_records) {
+        records.push_back({r.sr_kind, r.sr_erase, r.sr_key, this->os_end + buffer.size() + sizeof(ObjectRecordHeader),
+                           r.sr_size});
+        appendRecord(buffer, r.sr_kind, r.sr_erase, r.sr_key, number, transaction.ot_payloads.data() + r.sr_offset,
+                     r.sr_size);
+    }
+    appendRecord(buffer, ok_commit, false, records.size(), number, nullptr, 0);
+    if (!writeAt(this->os_fd, buffer.data(), buffer.size(), this->os_end) || fsync(this->os_fd) != 0) {
+        if (ftruncate(this->os_fd, static_cast<off_t>(this->os_end)) != 0) {
+            throw std::runtime_error("can't commit to object store, an incomplete transaction is left in the file");
+        }
+        throw std::runtime_error("can't commit to object store");
+    }
+    for (const auto &r: records) {
+        applyRecord(r.pr_kind, r.pr_erase, r.pr_key, {r.pr_offset, r.pr_size});
+    }
+    this->os_end += buffer.size();
+    this->os_transaction = number;
+    transaction.clear();
+    // old versions are dropped once they take more room than the current ones; the transaction is already durable,
+    // so a failed compaction leaves the file as it was and is only tried again after the next commit
+    std::uint64_t dead_bytes = this->os_end - sizeof(ObjectStoreHeader) - this->os_live_bytes;
+    if (this->os_end > OBJECT_STORE_COMPACTION_SIZE && dead_bytes > this->os_live_bytes) {
+        try {
+            compactFile();
+        } catch (const std::exception& e) {
+            if (is_debug_mode) std::cout << e.what() << "\n";
+        }
+    }
+}
+
+void ObjectStore::compact() {
+    std::lock_guard lock(this->os_mutex);
+    if (this->os_fd < 0) {
+        throw std::runtime_error("can't compact object store: object store is not open");
+    }
+    compactFile();
+}
+
+// writes the current version of every object as a single transaction into a temporary file and renames it over
+// the store, so that a crash at any point leaves either the old or the new file
+void ObjectStore::compactFile() {
+    std::string header = makeStoreHeader();
+    std::vector<char> buffer(header.begin(), header.end());
+    std::array<std::unordered_map<std::uint64_t, ObjectLocation>, OBJECT_KIND_COUNT> index;
+    std::uint64_t live_bytes = 0;
+    std::uint64_t count = 0;
+    for (std::size_t kind = 0; kind < OBJECT_KIND_COUNT; ++kind) {
+        std::vector<std::pair<std::uint64_t, ObjectLocation>> objects(this->os_index[kind].begin(),
+                                                                      this->os_index[kind].end());
+        std::sort(objects.begin(), objects.end(), [](const auto &a, const auto &b) {
+            return a.second.ol_offset < b.second.ol_offset;
+        });
+        for (const auto &[key, location]: objects) {
+            std::vector<std::uint8_t> payload = readPayload(location);
+            std::uint64_t offset = buffer.size() + sizeof(ObjectRecordHeader);
+            appendRecord(buffer, object_kind(kind), false, key, this->os_transaction, payload.data(), location.ol_size);
+            index[kind].emplace(key, ObjectLocation{offset, location.ol_size});
+            live_bytes += sizeof(ObjectRecordHeader) + location.ol_size;
+            ++count;
+        }
+    }
+    appendRecord(buffer, ok_commit, false, count, this->os_transaction, nullptr, 0);
+
+    std::string temp_path = this->os_path + ".tmp";
+    int fd = ::open(temp_path.c_str(), O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (fd < 0) {
+        throw std::runtime_error("can't compact object store");
+    }
+    if (!writeAt(fd, buffer.data(), buffer.size(), 0) || fsync(fd) != 0 ||
+        std::rename(temp_path.c_str(), this->os_path.c_str()) != 0) {
+        ::close(fd);
+        fs::remove(temp_path);
+        throw std::runtime_error("can't compact object store");
+    }
+    syncDirectory(this->os_path);
+    ::close(this->os_fd);
+    this->os_fd = fd;
+    this->os_index = std::move(index);
+    this->os_end = buffer.size();
+    this->os_live_bytes = live_bytes;
+}
+
+std::vector<std::uint8_t> ObjectStore::readPayload(const ObjectLocation &location) const {
+    std::vector<std::uint8_t> payload(location.ol_size);
+    if (!readAt(this->os_fd, reinterpret_cast<char *>(payload.data()), payload.size(), location.ol_offset)) {
+        throw std::runtime_error("can't read object store");
+    }
+    return payload;
+}
+
+// committed version of the object, std::nullopt if there is no such object
+std::optional<json> ObjectStore::get(object_kind kind, std::uint64_t key) const {
+    if (kind >= OBJECT_KIND_COUNT) {
+        return std::nullopt;
+    }
+    std::lock_guard lock(this->os_mutex);
+    auto it = this->os_index[kind].find(key);
+    if (it == this->os_index[kind].end()) {
+        return std::nullopt;
+    }
+    return json::from_cbor(readPayload(it->second));
+}
+
+std::vector<std::uint64_t> ObjectStore::getKeys(object_kind kind) const {
+    std::vector<std::uint64_t> keys;
+    if (kind >= OBJECT_KIND_COUNT) {
+        return keys;
+    }
+    std::lock_guard lock(this->os_mutex);
+    keys.reserve(this->os_index[kind].size());
+    for (const auto &item: this->os_index[kind]) {
+        keys.push_back(item.first);
+    }
+    std::sort(keys.begin(), keys.end());
+    return keys;
+}
+
+// committed versions of all objects of the kind, read in the order they lie in the file
+std::vector<json> ObjectStore::getAll(object_kind kind) const {
+    std::vector<json> objects;
+    if (kind >= OBJECT_KIND_COUNT) {
+        return objects;
+    }
+    std::lock_guard lock(this->os_mutex);
+    std::vector<ObjectLocation> locations;
+    locations.reserve(this->os_index[kind].size());
+    for (const auto &item: this->os_index[kind]) {
+        locations.push_back(item.second);
+    }
+    std::sort(locations.begin(), locations.end(), [](const ObjectLocation &a, const ObjectLocation &b) {
+        return a.ol_offset < b.ol_offset;
+    });
+    objects.reserve(locations.size());
+    for (const auto &location: locations) {
+        objects.push_back(json::from_cbor(readPayload(location)));
+    }
+    return objects;
+}
+
+std::size_t ObjectStore::size(object_kind kind) const {
+    std::lock_guard lock(this->os_mutex);
+    return kind < OBJECT_KIND_COUNT ? this->os_index[kind].size() : 0;
+}
+
+std::uint64_t ObjectStore::getFileSize() const {
+    std::lock_guard lock(this->os_mutex);
+    return this->os_end;
+}
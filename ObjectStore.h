@@ -0,0 +1,126 @@
+#ifndef ACE_ARTILLERY1_0_OBJECTSTORE_H
+#define ACE_ARTILLERY1_0_OBJECTSTORE_H
+
+#include "dependencies.h"
+#include <array>
+#include <mutex>
+#include <optional>
+
+// version of the object store file layout, must be increased after any change of the layout
+constexpr std::uint32_t OBJECT_STORE_VERSION = 1;
+
+// the file is compacted after a commit once it is larger than this and holds more dead bytes than live ones
+constexpr std::uint64_t OBJECT_STORE_COMPACTION_SIZE = 1 << 20;
+
+// marks the start of every record, so that garbage after a torn write is not taken for a record
+constexpr std::uint32_t OBJECT_RECORD_MAGIC = 0x4a424f52;
+
+// name of the object store file kept in the object_data directory
+extern const std::string object_store_name;
+
+// kinds of stored objects, every kind has its own key space
+enum object_kind : u_int8_t {
+    ok_gun,
+    ok_target,
+    ok_solution,
+    ok_commit               // not an object: closes a transaction
+};
+
+constexpr std::size_t OBJECT_KIND_COUNT = ok_commit;
+
+// header of the object store file, followed by records
+struct ObjectStoreHeader {
+    char sh_magic[8];                   // "ACEOBJ" followed by zero bytes
+    std::uint32_t sh_version;           // OBJECT_STORE_VERSION at the time of writing
+    std::uint32_t sh_reserved;          // Zero
+};
+
+// header of a record, followed by its payload (the object as CBOR, empty for erasures and commits)
+struct ObjectRecordHeader {
+    std::uint32_t or_magic;             // OBJECT_RECORD_MAGIC
+    std::uint8_t or_kind;               // object_kind of the object, ok_commit for the last record of a transaction
+    std::uint8_t or_erase;              // 1 if the record removes the object
+    std::uint16_t or_reserved;          // Zero
+    std::uint32_t or_size;              // Size of the payload in bytes
+    std::uint32_t or_transaction;       // Number of the transaction the record belongs to
+    std::uint64_t or_key;               // Key of the object within its kind, number of records for commit records
+    std::uint64_t or_checksum;          // FNV-1a hash of the header (with zero checksum) and the payload
+};
+
+// place of the latest version of an object in the file
+struct ObjectLocation {
+    std::uint64_t ol_offset;            // Offset of the payload
+    std::uint32_t ol_size;              // Size of the payload in bytes
+};
+
+// changes of objects collected by one caller, appended to the store as a single transaction by ObjectStore::commit();
+// every caller stages into its own transaction, so that transactions of different threads never mix
+class ObjectTransaction {
+private:
+    struct StagedRecord {
+        object_kind sr_kind;
+        bool sr_erase;
+        std::uint64_t sr_key;
+        std::uint64_t sr_offset;        // Offset of the payload within ot_payloads
+        std::uint32_t sr_size;
+    };
+    std::vector<std::uint8_t> ot_payloads;                  // Payloads of all records back to back
+    std::vector<StagedRecord> ot_records;
+    friend class ObjectStore;
+public:
+    void put(object_kind kind, std::uint64_t key, const json& object);
+    void erase(object_kind kind, std::uint64_t key);
+    void clear();
+    [[nodiscard]] bool empty() const;
+    [[nodiscard]] std::size_t size() const;
+};
+
+// all guns, targets and firing solutions kept in a single append-only file with an in-memory index:
+// changes are collected into a transaction, which commit() appends with one write and one fsync, closed by a commit
+// record; records after the last complete commit (a torn write) are ignored and cut off when the file is opened;
+// superseded versions stay in the file until it is compacted (rewritten with live objects only and renamed)
+class ObjectStore {
+private:
+    struct PendingRecord {
+        object_kind pr_kind;
+        bool pr_erase;
+        std::uint64_t pr_key;
+        std::uint64_t pr_offset;        // Offset of the payload within the file
+        std::uint32_t pr_size;
+    };
+    std::string os_path;
+    int os_fd = -1;
+    std::uint64_t os_end = 0;                               // End of the last committed transaction
+    std::uint64_t os_live_bytes = 0;                        // Bytes of records of the indexed objects
+    std::uint32_t os_transaction = 0;                       // Number of the last committed transaction
+    std::array<std::unordered_map<std::uint64_t, ObjectLocation>, OBJECT_KIND_COUNT> os_index;
+    mutable std::mutex os_mutex;
+
+    void applyRecord(object_kind kind, bool erase, std::uint64_t key, ObjectLocation location);
+    void scan();
+    void closeFile();
+    void compactFile();
+    [[nodiscard]] std::vector<std::uint8_t> readPayload(const ObjectLocation& location) const;
+public:
+    ObjectStore() = default;
+    ObjectStore(const ObjectStore&) = delete;
+    ObjectStore& operator=(const ObjectStore&) = delete;
+    ~ObjectStore();
+
+    void open(const std::string& path);
+    void close();
+    [[nodiscard]] bool isOpen() const;
+    [[nodiscard]] std::string getPath() const;
+    [[nodiscard]] ObjectTransaction begin() const;
+    void commit(ObjectTransaction& transaction);
+    void compact();
+    [[nodiscard]] std::optional<json> get(object_kind kind, std::uint64_t key) const;
+    [[nodiscard]] std::vector<std::uint64_t> getKeys(object_kind kind) const;
+    [[nodiscard]] std::vector<json> getAll(object_kind kind) const;
+    [[nodiscard]] std::size_t size(object_kind kind) const;
+    [[nodiscard]] std::uint64_t getFileSize() const;
+};
+
+extern ObjectStore object_store;
+
+#endif //ACE_ARTILLERY1_0_OBJECTSTORE_H
@@ -1,5 +1,6 @@
 #include "Process.h"
 #include "dependencies.h"
+#include "ObjectStore.h"
 
 
 
@@ -18,10 +19,80 @@ void clearProjectPath() {
     project_path = "";
 }
 
+// opens the object store of the current project, the store is kept open while the project path stays the same
+static ObjectStore& getProjectStore() {
+    std::string path = project_path + "/object_data/" + object_store_name;
+    if (!object_store.isOpen() || object_store.getPath() != path) {
+        fs::create_directories(project_path + "/object_data");
+        object_store.open(path);
+    }
+    return object_store;
+}
+
+static u_int64_t solutionKey(unsigned int gun_id, unsigned int target_id) {
+    return (static_cast<u_int64_t>(gun_id) << 32) | target_id;
+}
+
+// adds erasures of all stored objects of the kind which are not kept to the transaction
+static void eraseStaleObjects(const ObjectStore& store, ObjectTransaction& transaction, object_kind kind,
+                              const std::unordered_set<u_int64_t>& kept) {
+    for (u_int64_t key : store.getKeys(kind)) {
+        if (!kept.contains(key)) {
+            transaction.erase(kind, key);
+        }
+    }
+}
+
+// the stage functions add the current state of one kind of objects to a transaction of the store,
+// objects removed since the last save are erased from it
+static void stageGunData(const ObjectStore& store, ObjectTransaction& transaction) {
+    std::unordered_set<u_int64_t> kept;
+    for(const auto& item : gun_map.snapshot()) {
+        transaction.put(ok_gun, item.first, gunToJSON(*item.second));
+        kept.insert(item.first);
+    }
+    eraseStaleObjects(store, transaction, ok_gun, kept);
+}
+
+static void stageTargetData(const ObjectStore& store, ObjectTransaction& transaction) {
+    std::unordered_set<u_int64_t> kept;
+    for(const auto& item : target_map.snapshot()) {
+        transaction.put(ok_target, item.first, targetToJSON(*item.second));
+        kept.insert(item.first);
+    }
+    eraseStaleObjects(store, transaction, ok_target, kept);
+}
+
+// written from a snapshot, so that the planner is not blocked and the solutions belong to a single version of the missions
+// every bound pair is saved, the snapshot only gives the firing data: a pair which can't be calculated at the moment
+// (e.g. the gun stands on the target) is saved without it and bound again on load
+static void stageTargetParameters(const ObjectStore& store, ObjectTransaction& transaction) {
+    std::unordered_set<u_int64_t> kept;
+    auto snapshot = gun_target_parameters.getSnapshot();
+    for (const auto& binding : gun_target_parameters.getBindings()) {
+        u_int64_t key = solutionKey(binding.fb_gun_id, binding.fb_target_id);
+        const FiringSolution* solution = snapshot->find(binding.fb_gun_id, binding.fb_target_id);
+        transaction.put(ok_solution, key, solution ? firingSolutionToJSON(*solution) : bindingToJSON(binding));
+        kept.insert(key);
+    }
+    eraseStaleObjects(store, transaction, ok_solution, kept);
+}
+
+static void stageClear(const ObjectStore& store, ObjectTransaction& transaction, object_kind kind) {
+    for (u_int64_t key : store.getKeys(kind)) {
+        transaction.erase(kind, key);
+    }
+}
+
+// guns, targets and firing solutions are saved as a single transaction of the object store;
+// a transaction that fails to stage or commit is simply dropped, the store keeps the previous save
 void saveData() {
-    saveGunData();
-    saveTargetData();
-    saveTargetParameters();
+    ObjectStore& store = getProjectStore();
+    ObjectTransaction transaction = store.begin();
+    stageGunData(store, transaction);
+    stageTargetData(store, transaction);
+    stageTargetParameters(store, transaction);
+    store.commit(transaction);
 }
 
 void loadData() {
@@ -31,77 +102,76 @@ void loadData() {
 }
 
 void saveGunData() {
-    for(const auto& item : gun_map) {
-        gunToJSON(item.second);
-    }
+    ObjectStore& store = getProjectStore();
+    ObjectTransaction transaction = store.begin();
+    stageGunData(store, transaction);
+    store.commit(transaction);
 }
 
 void saveTargetData() {
-    for(const auto& item : target_map) {
-        targetToJSON(item.second);
-    }
+    ObjectStore& store = getProjectStore();
+    ObjectTransaction transaction = store.begin();
+    stageTargetData(store, transaction);
+    store.commit(transaction);
 }
 
 void saveTargetParameters() {
-    for(const auto& outer_item : gun_target_parameters) {
-        for(const auto& inner_item : outer_item.second) {
-            targetParametersToJSON(inner_item.second);
-        }
-    }
+    ObjectStore& store = getProjectStore();
+    ObjectTransaction transaction = store.begin();
+    stageTargetParameters(store, transaction);
+    store.commit(transaction);
 }
 
+// guns and targets keep the IDs under which they were saved, since solutions and the keys of the store refer to them;
+// IDs generated afterwards follow the largest loaded one
 void loadGunData() {
-    std::cout << chdir((project_path+"/object_data/guns").c_str());
-    std::vector<Gun> guns_from_files;
-    for(const auto& file: fs::directory_iterator(fs::current_path())) {
-        guns_from_files.push_back(gunFromJSON(file.path()));
+    std::vector<Gun> guns_from_store;
+    for (const auto& gun_json : getProjectStore().getAll(ok_gun)) {
+        guns_from_store.push_back(gunFromJSON(gun_json));
     }
-    for (const auto& gun : guns_from_files) {
-        gun_map.insert(std::make_pair(gun.getGunID(), gun));
+    for (const auto& gun : guns_from_store) {
+        gun_map.insert(gun.getGunID(), gun);
+        reserveUniqueID(gun.getGunID());
     }
-    chdir(project_path.c_str());
 }
 
 void loadTargetData() {
-    std::cout << chdir((project_path+"/object_data/targets").c_str());
-    std::vector<Target> targets_from_files;
-    for(const auto& file: fs::directory_iterator(fs::current_path())) {
-        targets_from_files.push_back(targetFromJSON(file.path()));
+    std::vector<Target> targets_from_store;
+    for (const auto& target_json : getProjectStore().getAll(ok_target)) {
+        targets_from_store.push_back(targetFromJSON(target_json));
     }
-    for (const auto& target : targets_from_files) {
-        target_map.insert(std::make_pair(target.getTargetID(), target));
+    for (const auto& target : targets_from_store) {
+        target_map.insert(target.getTargetID(), target);
+        reserveUniqueID(target.getTargetID());
     }
-    chdir(project_path.c_str());
 }
 
+// binds the loaded targets to the loaded guns with the saved charge types, guns and targets must be loaded first;
+// the firing data is recalculated by the fire mission store, so it follows the tables in use
 void loadTargetParameters() {
-    std::cout << chdir((project_path+"/object_data/parameters").c_str());
-    std::vector<GunTargetParameters> parameters_from_files;
-    for(const auto& file: fs::directory_iterator(fs::current_path())) {
-        parameters_from_files.push_back(targetParametersFromJSON(file.path()));
+    std::vector<GunTargetParameters> parameters_from_store;
+    for (const auto& params_json : getProjectStore().getAll(ok_solution)) {
+        parameters_from_store.push_back(targetParametersFromJSON(params_json));
+    }
+    for (const auto& params : parameters_from_store) {
+        gun_target_parameters.restore(params.getGunReference(), *params.getTargetPointer(), params.getCharge());
     }
-    // TODO: write the insertion of target parameters into gun_target_parameters structure
-    chdir(project_path.c_str());
 }
 
 void insertGun(const Gun& g) {
-    gun_map.insert(std::make_pair(g.getGunID(), g));
+    gun_map.insert(g.getGunID(), g);
 }
 
 void insertTarget(const Target& t) {
-    target_map.insert(std::make_pair(t.getTargetID(), t));
+    target_map.insert(t.getTargetID(), t);
 }
 
 void eraseGun(const Gun& g) {
-    if (gun_map.find(g.getGunID()) != gun_map.end()) {
-        gun_map.erase(g.getGunID());
-    } else throw std::runtime_error("can't erase from gun map: no such gun");
+    if (!gun_map.erase(g.getGunID())) throw std::runtime_error("can't erase from gun map: no such gun");
 }
 
 void eraseTarget(const Target& t) {
-    if (target_map.find(t.getTargetID()) != target_map.end()) {
-        target_map.erase(t.getTargetID());
-    } else throw std::runtime_error("can't erase from target map: no such target");
+    if (!target_map.erase(t.getTargetID())) throw std::runtime_error("can't erase from target map: no such target");
 }
 
 void assignTargetForGun(Gun& g, Target& t){
@@ -117,11 +187,16 @@ void dismissMissionForGun(Gun& g) {
 }
 
 void dismissAllMissions() {
-    for(auto gun_pair : gun_map) {
-        gun_pair.second.removeAllTargets();
+    for(const auto& gun_pair : gun_map.snapshot()) {
+        Gun gun = *gun_pair.second;
+        gun.removeAllTargets();
     }
 }
 
+void updateAllMissions() {
+    gun_target_parameters.updateAll();
+}
+
 
 void printGunMission(const Gun& g){
     
@@ -136,34 +211,33 @@ void printTargets(){
 }
 
 void clearData() {
-    clearGunData();
-    clearTargetData();
-    clearParameterData();
+    ObjectStore& store = getProjectStore();
+    ObjectTransaction transaction = store.begin();
+    stageClear(store, transaction, ok_gun);
+    stageClear(store, transaction, ok_target);
+    stageClear(store, transaction, ok_solution);
+    store.commit(transaction);
 }
 
 void clearGunData() {
-    std::cout << chdir((project_path+"/object_data/guns").c_str());
-    for(const auto& entry: fs::directory_iterator(fs::current_path())) {
-        fs::remove(entry.path());
-    }
-    chdir(project_path.c_str());
+    ObjectStore& store = getProjectStore();
+    ObjectTransaction transaction = store.begin();
+    stageClear(store, transaction, ok_gun);
+    store.commit(transaction);
 }
 
 void clearTargetData() {
-    chdir((project_path+"/object_data/targets").c_str());
-    for(const auto& entry: fs::directory_iterator(fs::current_path())) {
-        std::cout << "removing " << entry.path() << "\n";
-        fs::remove(entry.path());
-    }
-    chdir(project_path.c_str());
+    ObjectStore& store = getProjectStore();
+    ObjectTransaction transaction = store.begin();
+    stageClear(store, transaction, ok_target);
+    store.commit(transaction);
 }
 
 void clearParameterData() {
-    chdir((project_path+"/object_data/parameters").c_str());
-    for(const auto& entry: fs::directory_iterator(fs::current_path())) {
-        fs::remove(entry.path());
-    }
-    chdir(project_path.c_str());
+    ObjectStore& store = getProjectStore();
+    ObjectTransaction transaction = store.begin();
+    stageClear(store, transaction, ok_solution);
+    store.commit(transaction);
 }
 
 json gunToJSON(const Gun& gun) {
@@ -179,27 +253,20 @@ json gunToJSON(const Gun& gun) {
     gun_json["direction reserve"] = static_cast<std::string>(gun.getDirectionRes());
     gun_json["direction night"] = static_cast<std::string>(gun.getDirectionNight());
     gun_json["number of targets"] = gun.getTargetNumber();
-    gun_json["gun charges"]["full"] = gun.getCharges()[lt_full];
-    gun_json["gun charges"]["reduced"] = gun.getCharges()[lt_reduced];
-    gun_json["gun charges"]["1st"] = gun.getCharges()[lt_1st];
-    gun_json["gun charges"]["2nd"] = gun.getCharges()[lt_2nd];
-    gun_json["gun charges"]["3rd"] = gun.getCharges()[lt_3rd];
-    gun_json["gun charges"]["4th"] = gun.getCharges()[lt_4th];
-    auto covers = gun.getCovers();
+    const auto& charges = gun.getCharges();
+    gun_json["gun charges"]["full"] = charges[lt_full];
+    gun_json["gun charges"]["reduced"] = charges[lt_reduced];
+    gun_json["gun charges"]["1st"] = charges[lt_1st];
+    gun_json["gun charges"]["2nd"] = charges[lt_2nd];
+    gun_json["gun charges"]["3rd"] = charges[lt_3rd];
+    gun_json["gun charges"]["4th"] = charges[lt_4th];
+    const auto& covers = gun.getCovers();
     for (int i = 0; i < covers.size(); ++i) {
         gun_json["covers"][i]["left"] = std::get<0>(covers[i]);
         gun_json["covers"][i]["right"] = std::get<1>(covers[i]);
         gun_json["covers"][i]["distance"] = std::get<2>(covers[i]);
         gun_json["covers"][i]["height"] = std::get<3>(covers[i]);
     }
-
-    // saving JSON file to objects directory
-    chdir((project_path+"/object_data/guns").c_str());
-    std::string name = gun.getGunName();
-    std::replace(name.begin(), name.end(), ' ', '_');
-    std::ofstream out(name+".txt");
-    out << gun_json.dump(4);
-    chdir(project_path.c_str());
     return gun_json;
 }
 
@@ -213,14 +280,6 @@ json targetToJSON(const Target& target) {
     target_json["h"] = target.getTargetH();
     target_json["front"] = target.getTargetFront();
     target_json["depth"] = target.getTargetDepth();
-
-    // saving JSON file to objects directory
-    chdir((project_path+"/object_data/targets").c_str());
-    std::string name = target.getTargetName();
-    std::replace(name.begin(), name.end(), ' ', '_');
-    std::ofstream out(name+".txt");
-    out << target_json.dump(4);
-    chdir(project_path.c_str());
     return target_json;
 }
 
@@ -240,20 +299,50 @@ json targetParametersToJSON(const GunTargetParameters& params) {
     for (int i = 0; i < ballistic_parameters.size(); ++i) {
         params_json["ballistic parameters"][i] = ballistic_parameters[i];
     }
+    return params_json;
+}
 
-    // saving JSON file to objects directory
-    chdir((project_path + "/object_data/parameters").c_str());
-    std::string name = "params_tgt_" + std::to_string(params.getTargetID());
-    name += "_for_gun_" + std::to_string(params.getGunID());
-    std::replace(name.begin(), name.end(), ' ', '_');
-    std::ofstream out(name + ".txt");
-    out << params_json.dump(4);
-    chdir(project_path.c_str());
+json bindingToJSON(const FireMissionBinding& binding) {
+    json params_json;
+    params_json["target id"] = binding.fb_target_id;
+    params_json["gun id"] = binding.fb_gun_id;
+    params_json["charge"] = binding.fb_charge;
     return params_json;
 }
 
+json firingSolutionToJSON(const FiringSolution& solution) {
+    json params_json;
+    params_json["distance"] = solution.fs_distance;
+    params_json["azimuth absolute"] = solution.fs_azimuth_abs;
+    params_json["azimuth main"] = solution.fs_azimuth_main;
+    params_json["azimuth reserve"] = solution.fs_azimuth_res;
+    params_json["azimuth turn"] = solution.fs_azimuth_turn;
+    params_json["target id"] = solution.fs_target_id;
+    params_json["gun id"] = solution.fs_gun_id;
+    params_json["elevation"] = solution.fs_elevation;
+    params_json["level"] = solution.fs_level;
+    params_json["charge"] = solution.fs_charge;
+    auto ballistic_parameters = solution.getBallisticParameters();
+    for (std::size_t i = 0; i < ballistic_parameters.size(); ++i) {
+        params_json["ballistic parameters"][i] = ballistic_parameters[i];
+    }
+    return params_json;
+}
+
+// reads an object from a JSON file, as written by the per-object persistence used before the object store
+static json readJSONFile(const std::string& json_filename) {
+    std::ifstream in(json_filename);
+    if (!in.is_open()) {
+        throw std::runtime_error("can't open JSON file");
+    }
+    return json::parse(in);
+}
+
 Gun gunFromJSON(const std::string& json_filename) {
-    json gun_json = json_filename;
+    return gunFromJSON(readJSONFile(json_filename));
+}
+
+Gun gunFromJSON(const json& gun_json) {
     double gun_x = gun_json["x"];
     double gun_y = gun_json["y"];
     double gun_h = gun_json["h"];
@@ -264,7 +353,7 @@ Gun gunFromJSON(const std::string& json_filename) {
     std::string name = gun_json["name"];
     std::string description = gun_json["description"];
 
-    std::map<charge_type, unsigned int> charges;
+    ChargeInventory charges;
     charges[lt_full] = gun_json["gun charges"]["full"];
     charges[lt_reduced] = gun_json["gun charges"]["reduced"];
     charges[lt_1st] = gun_json["gun charges"]["1st"];
@@ -273,21 +362,25 @@ Gun gunFromJSON(const std::string& json_filename) {
     charges[lt_4th] = gun_json["gun charges"]["4th"];
 
     std::vector<std::tuple<Mil, Mil, int, int>> covers;
-    for (const auto &cover: gun_json["covers"]) {
+    for (const auto &cover: gun_json.value("covers", json::array())) {
         Mil left((std::string) cover["left"]);
         Mil right((std::string) cover["right"]);
         int distance = cover["distance"];
         int height = cover["height"];
         covers.emplace_back(left, right, distance, height);
     }
-    Gun g(gun_x, gun_y, gun_h, gun_dir, gun_dir_main, gun_dir_res, gun_dir_night,
+    unsigned int id = gun_json.contains("id") ? static_cast<unsigned int>(gun_json["id"]) : generateUniqueID();
+    Gun g(id, gun_x, gun_y, gun_h, gun_dir, gun_dir_main, gun_dir_res, gun_dir_night,
           name, description, charges, covers);
     return g;
 }
 
 
-Target targetFromJSON (const std::string& json_filename) {
-    json target_json = json_filename;
+Target targetFromJSON(const std::string& json_filename) {
+    return targetFromJSON(readJSONFile(json_filename));
+}
+
+Target targetFromJSON(const json& target_json) {
     double tg_x = target_json["x"];
     double tg_y = target_json["y"];
     double tg_h = target_json["h"];
@@ -295,14 +388,26 @@ Target targetFromJSON (const std::string& json_filename) {
     double tg_depth = target_json["depth"];
     std::string name = target_json["name"];
     std::string description = target_json["description"];
-    Target t(tg_x, tg_y, tg_h, tg_front, tg_depth, name, description);
+    unsigned int id = target_json.contains("id") ? static_cast<unsigned int>(target_json["id"]) : generateUniqueID();
+    Target t(id, tg_x, tg_y, tg_h, tg_front, tg_depth, name, description);
     return t;
 }
 
 GunTargetParameters targetParametersFromJSON(const std::string& json_filename) {
-    json params_json = json_filename;
+    return targetParametersFromJSON(readJSONFile(json_filename));
+}
+
+// a pair saved without firing data only binds the target to the gun, the data is calculated once it is bound again
+GunTargetParameters targetParametersFromJSON(const json& params_json) {
     unsigned int target_id = params_json["target id"];
     unsigned int gun_id = params_json["gun id"];
+    if (!params_json.contains("distance")) {
+        GunTargetParameters params(std::make_shared<const Gun>());
+        params.setTarget(target_id);
+        params.setGun(gun_id);
+        params.setCharge(params_json["charge"]);
+        return params;
+    }
     double distance = params_json["distance"];
     Mil azimuth_abs((std::string) params_json["azimuth absolute"]);
     Mil azimuth_main((std::string) params_json["azimuth main"]);
@@ -312,11 +417,10 @@ GunTargetParameters targetParametersFromJSON(const std::string& json_filename) {
     Mil level((std::string) params_json["level"]);
     charge_type charge = params_json["charge"];
     std::vector<double> ballistic_parameters;
-    for (const auto &param: params_json["ballistic parameters"]) {
+    for (const auto &param: params_json.value("ballistic parameters", json::array())) {
         ballistic_parameters.push_back(param);
     }
-    Gun g;
-    GunTargetParameters params(g);
+    GunTargetParameters params(std::make_shared<const Gun>());
     params.setTarget(target_id);
     params.setGun(gun_id);
     params.setDistance(distance);
@@ -3,6 +3,7 @@
 
 #include "dependencies.h"
 #include "Gun.h"
+#include "FireMissionStore.h"
 #include "Data.h"
 #include "Process.h"
 
@@ -30,6 +31,8 @@ void dismissMissionForGun(Gun& g);
 
 void dismissAllMissions();
 
+void updateAllMissions();
+
 void printGunMission(const Gun& g);
 
 void printGuns();
@@ -66,12 +69,22 @@ json targetToJSON(const Target& target);
 
 json targetParametersToJSON(const GunTargetParameters& params);
 
+json firingSolutionToJSON(const FiringSolution& solution);
+
+json bindingToJSON(const FireMissionBinding& binding);
+
 Gun gunFromJSON(const std::string& json_filename);
 
+Gun gunFromJSON(const json& gun_json);
+
 Target targetFromJSON(const std::string& json_filename);
 
+Target targetFromJSON(const json& target_json);
+
 GunTargetParameters targetParametersFromJSON(const std::string& json_filename);
 
+GunTargetParameters targetParametersFromJSON(const json& params_json);
+
 
 
 #endif //ACE_ARTILLERY1_0_PROCESS_H
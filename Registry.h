@@ -0,0 +1,115 @@
+#ifndef ACE_ARTILLERY1_0_REGISTRY_H
+#define ACE_ARTILLERY1_0_REGISTRY_H
+
+#include "dependencies.h"
+#include <array>
+#include <shared_mutex>
+
+// number of independently locked parts of a registry, IDs are spread over them by their remainder
+constexpr std::size_t REGISTRY_SHARD_COUNT = 16;
+
+// objects (guns, targets) by ID, shared between threads: every shard of the registry has its own lock,
+// so that operations on objects of different shards never wait for each other;
+// stored objects are immutable snapshots, a change replaces the snapshot (copy on write), so a reader only holds
+// the shard lock while copying the pointer and keeps a consistent object however long it uses it
+template<typename T>
+class Registry {
+private:
+    struct Shard {
+        mutable std::shared_mutex rs_mutex;
+        std::unordered_map<unsigned int, std::shared_ptr<const T>> rs_objects;
+    };
+    std::array<Shard, REGISTRY_SHARD_COUNT> rg_shards;
+
+    Shard& getShard(unsigned int id) {
+        return this->rg_shards[id % REGISTRY_SHARD_COUNT];
+    }
+
+    const Shard& getShard(unsigned int id) const {
+        return this->rg_shards[id % REGISTRY_SHARD_COUNT];
+    }
+
+public:
+    // adds the object under the ID, returns false (and keeps the present object) if the ID is taken
+    bool insert(unsigned int id, const T& object) {
+        auto snapshot = std::make_shared<const T>(object);
+        Shard& shard = getShard(id);
+        std::unique_lock lock(shard.rs_mutex);
+        return shard.rs_objects.emplace(id, std::move(snapshot)).second;
+    }
+
+    // adds the object or replaces the present one
+    void assign(unsigned int id, const T& object) {
+        auto snapshot = std::make_shared<const T>(object);
+        Shard& shard = getShard(id);
+        std::unique_lock lock(shard.rs_mutex);
+        shard.rs_objects.insert_or_assign(id, std::move(snapshot));
+    }
+
+    // applies the change to a copy of the object and publishes the copy, returns false if there is no such object;
+    // readers keep seeing the previous snapshot until the change is done, concurrent changes of one object are applied
+    // one after another
+    template<typename F>
+    bool update(unsigned int id, F&& change) {
+        Shard& shard = getShard(id);
+        std::unique_lock lock(shard.rs_mutex);
+        auto it = shard.rs_objects.find(id);
+        if (it == shard.rs_objects.end()) {
+            return false;
+        }
+        auto copy = std::make_shared<T>(*it->second);
+        std::forward<F>(change)(*copy);
+        it->second = std::move(copy);
+        return true;
+    }
+
+    bool erase(unsigned int id) {
+        Shard& shard = getShard(id);
+        std::unique_lock lock(shard.rs_mutex);
+        return shard.rs_objects.erase(id) != 0;
+    }
+
+    // current snapshot of the object, nullptr if there is no such object
+    [[nodiscard]] std::shared_ptr<const T> find(unsigned int id) const {
+        const Shard& shard = getShard(id);
+        std::shared_lock lock(shard.rs_mutex);
+        auto it = shard.rs_objects.find(id);
+        return it == shard.rs_objects.end() ? nullptr : it->second;
+    }
+
+    [[nodiscard]] bool contains(unsigned int id) const {
+        const Shard& shard = getShard(id);
+        std::shared_lock lock(shard.rs_mutex);
+        return shard.rs_objects.contains(id);
+    }
+
+    // snapshots of all objects in ascending order of ID; shards are read one by one, so objects added or removed
+    // during the call may or may not be included
+    [[nodiscard]] std::vector<std::pair<unsigned int, std::shared_ptr<const T>>> snapshot() const {
+        std::vector<std::pair<unsigned int, std::shared_ptr<const T>>> objects;
+        for (const Shard& shard: this->rg_shards) {
+            std::shared_lock lock(shard.rs_mutex);
+            objects.insert(objects.end(), shard.rs_objects.begin(), shard.rs_objects.end());
+        }
+        std::sort(objects.begin(), objects.end(), [](const auto& a, const auto& b) { return a.first < b.first; });
+        return objects;
+    }
+
+    [[nodiscard]] std::size_t size() const {
+        std::size_t count = 0;
+        for (const Shard& shard: this->rg_shards) {
+            std::shared_lock lock(shard.rs_mutex);
+            count += shard.rs_objects.size();
+        }
+        return count;
+    }
+
+    void clear() {
+        for (Shard& shard: this->rg_shards) {
+            std::unique_lock lock(shard.rs_mutex);
+            shard.rs_objects.clear();
+        }
+    }
+};
+
+#endif //ACE_ARTILLERY1_0_REGISTRY_H
@@ -0,0 +1,199 @@
+#include "TableCache.h"
+
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+const std::string table_cache_name = "tables.bin";
+
+static constexpr char table_cache_magic[8] = {'A', 'C', 'E', 'T', 'B', 'L', 0, 0};
+
+std::uint64_t fnv1aHash(const void *data, std::size_t size, std::uint64_t hash) {
+    auto bytes = static_cast<const unsigned char *>(data);
+    for (std::size_t i = 0; i < size; ++i) {
+        hash ^= bytes[i];
+        hash *= 1099511628211ull;
+    }
+    return hash;
+}
+
+std::uint64_t getTableSourceStamp(const std::string &tables_path) {
+    std::uint64_t stamp = fnv1aHash(nullptr, 0);
+    std::error_code ec;
+    for (const auto *names: {&ballistic_table_names, &distance_table_names}) {
+        for (const auto &name: *names) {
+            fs::path path = fs::path(tables_path) / name;
+            auto size = static_cast<std::uint64_t>(fs::file_size(path, ec));
+            if (ec) return 0;
+            auto time = static_cast<std::int64_t>(fs::last_write_time(path, ec).time_since_epoch().count());
+            if (ec) return 0;
+            stamp = fnv1aHash(name.data(), name.size(), stamp);
+            stamp = fnv1aHash(&size, sizeof(size), stamp);
+            stamp = fnv1aHash(&time, sizeof(time), stamp);
+        }
+    }
+    return stamp;
+}
+
+// appends a table to the payload: row and column counts, distances padded to 8 bytes, then the rows
+static void appendTable(std::vector<char> &payload, std::span<const int> distances, std::size_t columns,
+                        std::span<const double> rows) {
+    auto append = [&payload](const void *data, std::size_t size) {
+        auto bytes = static_cast<const char *>(data);
+        payload.insert(payload.end(), bytes, bytes + size);
+    };
+    auto row_count = static_cast<std::uint32_t>(distances.size());
+    auto column_count = static_cast<std::uint32_t>(columns);
+    append(&row_count, sizeof(row_count));
+    append(&column_count, sizeof(column_count));
+    for (int d: distances) {
+        auto d32 = static_cast<std::int32_t>(d);
+        append(&d32, sizeof(d32));
+    }
+    if (row_count % 2) {
+        std::int32_t padding = 0;
+        append(&padding, sizeof(padding));
+    }
+    append(rows.data(), rows.size_bytes());
+}
+
+// finds a table in the payload written by appendTable() and refers to its distances and rows in place, returns false
+// if the payload is too short or misaligned or the column count doesn't fit a row of the given width (a row of every
+// table is at most BallisticTable::stride wide)
+static bool extractTable(const char *&cursor, const char *end, std::size_t width,
+                         std::span<const int> &distances, std::size_t &columns, std::span<const double> &rows) {
+    std::uint32_t row_count, column_count;
+    if (end - cursor < static_cast<std::ptrdiff_t>(2 * sizeof(std::uint32_t))) return false;
+    if (reinterpret_cast<std::uintptr_t>(cursor) % alignof(double) != 0) return false;
+    std::memcpy(&row_count, cursor, sizeof(row_count));
+    std::memcpy(&column_count, cursor + sizeof(row_count), sizeof(column_count));
+    cursor += 2 * sizeof(std::uint32_t);
+    if (column_count == 0 || column_count > BallisticTable::stride) return false;
+    if (width == 0) width = column_count;
+    std::size_t distance_bytes = (row_count + row_count % 2) * sizeof(std::int32_t);
+    std::size_t row_bytes = static_cast<std::size_t>(row_count) * width * sizeof(double);
+    if (static_cast<std::size_t>(end - cursor) < distance_bytes + row_bytes) return false;
+    distances = {reinterpret_cast<const int *>(cursor), row_count};
+    cursor += distance_bytes;
+    rows = {reinterpret_cast<const double *>(cursor), static_cast<std::size_t>(row_count) * width};
+    cursor += row_bytes;
+    columns = column_count;
+    return true;
+}
+
+// mapping of the cache the loaded tables refer to, unmapped when another cache is mapped in its place
+static void *table_cache_data = nullptr;
+static std::size_t table_cache_size = 0;
+
+bool readTableCache(const std::string &tables_path) {
+    std::string cache_path = tables_path + "/" + table_cache_name;
+    int fd = open(cache_path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        return false;
+    }
+    struct stat st{};
+    if (fstat(fd, &st) != 0 || st.st_size < static_cast<off_t>(sizeof(TableCacheHeader))) {
+        close(fd);
+        return false;
+    }
+    auto size = static_cast<std::size_t>(st.st_size);
+    void *mapped = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (mapped == MAP_FAILED) {
+        return false;
+    }
+    auto release = [mapped, size]() { munmap(mapped, size); };
+
+    TableCacheHeader header{};
+    std::memcpy(&header, mapped, sizeof(header));
+    const char *payload = static_cast<const char *>(mapped) + sizeof(header);
+    const char *end = static_cast<const char *>(mapped) + size;
+    // if the csv tables are not present (e.g. on field units) the cache is trusted as long as its checksum matches
+    std::uint64_t source_stamp = getTableSourceStamp(tables_path);
+    if (std::memcmp(header.tc_magic, table_cache_magic, sizeof(table_cache_magic)) != 0 ||
+        header.tc_version != TABLE_CACHE_VERSION ||
+        header.tc_stride != BallisticTable::stride ||
+        header.tc_ballistic_count != ballistic_table_names.size() ||
+        header.tc_distance_count != distance_table_names.size() ||
+        header.tc_payload_size != size - sizeof(header) ||
+        (source_stamp != 0 && header.tc_source_stamp != source_stamp) ||
+        header.tc_checksum != fnv1aHash(payload, header.tc_payload_size)) {
+        release();
+        return false;
+    }
+
+    // the tables refer to the mapped rows instead of copying them, as the compiled-in tables do
+    std::vector<BallisticTable> ballistic;
+    std::vector<DistanceTable> distance;
+    const char *cursor = payload;
+    std::span<const int> distances;
+    std::span<const double> rows;
+    std::size_t columns;
+    try {
+        for (std::size_t i = 0; i < header.tc_ballistic_count; ++i) {
+            if (!extractTable(cursor, end, BallisticTable::stride, distances, columns, rows)) {
+                release();
+                return false;
+            }
+            ballistic.emplace_back(columns);
+            ballistic.back().assignView(distances, rows);
+        }
+        for (std::size_t i = 0; i < header.tc_distance_count; ++i) {
+            if (!extractTable(cursor, end, 0, distances, columns, rows)) {
+                release();
+                return false;
+            }
+            distance.emplace_back(columns);
+            distance.back().assignView(distances, rows);
+        }
+    } catch (const std::runtime_error &) {
+        // rows out of order in a cache with a matching checksum
+        release();
+        return false;
+    }
+    ballistic_tables = std::move(ballistic);
+    distance_tables = std::move(distance);
+    if (table_cache_data) {
+        munmap(table_cache_data, table_cache_size);
+    }
+    table_cache_data = mapped;
+    table_cache_size = size;
+    return true;
+}
+
+void writeTableCache(const std::string &tables_path) {
+    std::vector<char> payload;
+    for (const auto &table: ballistic_tables) {
+        appendTable(payload, table.getDistances(), table.getColumns(), table.getRows());
+    }
+    for (const auto &table: distance_tables) {
+        appendTable(payload, table.getDistances(), table.getColumns(), table.getRows());
+    }
+
+    TableCacheHeader header{};
+    std::memcpy(header.tc_magic, table_cache_magic, sizeof(table_cache_magic));
+    header.tc_version = TABLE_CACHE_VERSION;
+    header.tc_stride = BallisticTable::stride;
+    header.tc_ballistic_count = static_cast<std::uint32_t>(ballistic_tables.size());
+    header.tc_distance_count = static_cast<std::uint32_t>(distance_tables.size());
+    header.tc_source_stamp = getTableSourceStamp(tables_path);
+    header.tc_payload_size = payload.size();
+    header.tc_checksum = fnv1aHash(payload.data(), payload.size());
+
+    // the cache is replaced by renaming, so that a reader never sees a partially written file
+    std::string cache_path = tables_path + "/" + table_cache_name;
+    std::string temp_path = cache_path + ".tmp";
+    {
+        std::ofstream out(temp_path, std::ios::binary | std::ios::trunc);
+        if (!out.is_open()) {
+            throw std::runtime_error("can't write table cache");
+        }
+        out.write(reinterpret_cast<const char *>(&header), sizeof(header));
+        out.write(payload.data(), static_cast<std::streamsize>(payload.size()));
+        if (!out) {
+            throw std::runtime_error("can't write table cache");
+        }
+    }
+    fs::rename(temp_path, cache_path);
+}
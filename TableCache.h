@@ -0,0 +1,38 @@
+#ifndef ACE_ARTILLERY1_0_TABLECACHE_H
+#define ACE_ARTILLERY1_0_TABLECACHE_H
+
+#include "dependencies.h"
+#include "Data.h"
+
+// version of the binary table cache layout, must be increased after any change of the layout
+constexpr std::uint32_t TABLE_CACHE_VERSION = 1;
+
+// name of the binary table cache file kept in the tables directory
+extern const std::string table_cache_name;
+
+// header of the binary table cache, followed by the payload with all ballistic and minimum distance tables
+struct TableCacheHeader {
+    char tc_magic[8];                   // "ACETBL" followed by zero bytes
+    std::uint32_t tc_version;           // TABLE_CACHE_VERSION at the time of writing
+    std::uint32_t tc_stride;            // BALLISTIC_ROW_STRIDE at the time of writing
+    std::uint32_t tc_ballistic_count;   // Number of ballistic tables in the payload
+    std::uint32_t tc_distance_count;    // Number of minimum distance tables in the payload
+    std::uint64_t tc_source_stamp;      // Hash of names, sizes and modification times of the csv tables
+    std::uint64_t tc_payload_size;      // Size of the payload in bytes
+    std::uint64_t tc_checksum;          // FNV-1a hash of the payload
+};
+
+// FNV-1a hash of a byte sequence, used for cache checksums
+std::uint64_t fnv1aHash(const void* data, std::size_t size, std::uint64_t hash = 14695981039346656037ull);
+
+// hash of names, sizes and modification times of the csv tables, 0 if any of them is missing
+std::uint64_t getTableSourceStamp(const std::string& tables_path);
+
+// maps the binary cache and loads all tables from it without parsing: the tables refer to the mapped rows, the mapping
+// is kept until a cache is loaded again; returns false if the cache is missing, damaged or older than the csv tables
+bool readTableCache(const std::string& tables_path);
+
+// writes the currently loaded tables into the binary cache (written to a temporary file and renamed)
+void writeTableCache(const std::string& tables_path);
+
+#endif //ACE_ARTILLERY1_0_TABLECACHE_H
@@ -0,0 +1,105 @@
+#include "TargetSlab.h"
+
+// whether the target lies elsewhere than its older copy, only the position enters the firing data
+bool TargetSlab::isMoved(const Target &older, const Target &target) {
+    return older.getTargetX() != target.getTargetX() || older.getTargetY() != target.getTargetY() ||
+           older.getTargetH() != target.getTargetH();
+}
+
+// whether the target differs from its older copy in anything kept by the slab and shown in snapshots
+bool TargetSlab::isChanged(const Target &older, const Target &target) {
+    return isMoved(older, target) || older.getTargetFront() != target.getTargetFront() ||
+           older.getTargetDepth() != target.getTargetDepth() || older.getTargetName() != target.getTargetName() ||
+           older.getTargetDescription() != target.getTargetDescription();
+}
+
+// handle of the target, the target is added if it is not in the slab yet; otherwise the kept copy is replaced as in
+// update() if the passed target differs from it, so that the slab holds the latest copy without copying a target
+// for every gun bound to it
+TargetHandle TargetSlab::acquire(const Target &target) {
+    auto it = this->sl_ids.find(target.getTargetID());
+    if (it != this->sl_ids.end()) {
+        Slot &slot = this->sl_slots[it->second];
+        if (isChanged(*slot.ts_target, target)) {
+            slot.ts_target = std::make_shared<const Target>(target);
+        }
+        ++slot.ts_refs;
+        return {it->second, slot.ts_generation};
+    }
+    u_int32_t index;
+    if (!this->sl_free.empty()) {
+        index = this->sl_free.back();
+        this->sl_free.pop_back();
+    } else {
+        index = static_cast<u_int32_t>(this->sl_slots.size());
+        this->sl_slots.emplace_back();
+    }
+    Slot &slot = this->sl_slots[index];
+    slot.ts_target = std::make_shared<const Target>(target);
+    slot.ts_refs = 1;
+    this->sl_ids.emplace(target.getTargetID(), index);
+    return {index, slot.ts_generation};
+}
+
+// gives the handle back, the target is removed when its last handle is released
+void TargetSlab::release(TargetHandle handle) {
+    if (!isValid(handle)) {
+        throw std::runtime_error("invalid target handle: target was released");
+    }
+    Slot &slot = this->sl_slots[handle.th_index];
+    if (--slot.ts_refs == 0) {
+        this->sl_ids.erase(slot.ts_target->getTargetID());
+        slot.ts_target.reset();
+        ++slot.ts_generation;
+        this->sl_free.push_back(handle.th_index);
+    }
+}
+
+// replaces the kept copy of the target, returns false if the target is not in the slab
+bool TargetSlab::update(const Target &target) {
+    auto it = this->sl_ids.find(target.getTargetID());
+    if (it == this->sl_ids.end()) {
+        return false;
+    }
+    this->sl_slots[it->second].ts_target = std::make_shared<const Target>(target);
+    return true;
+}
+
+void TargetSlab::clear() {
+    this->sl_slots.clear();
+    this->sl_free.clear();
+    this->sl_ids.clear();
+}
+
+bool TargetSlab::isValid(TargetHandle handle) const {
+    return handle.th_index < this->sl_slots.size() &&
+           this->sl_slots[handle.th_index].ts_generation == handle.th_generation &&
+           this->sl_slots[handle.th_index].ts_target != nullptr;
+}
+
+const TargetSlab::Slot &TargetSlab::getSlot(TargetHandle handle) const {
+    if (!isValid(handle)) {
+        throw std::runtime_error("invalid target handle: target was released");
+    }
+    return this->sl_slots[handle.th_index];
+}
+
+const Target &TargetSlab::get(TargetHandle handle) const {
+    return *getSlot(handle).ts_target;
+}
+
+const std::shared_ptr<const Target> &TargetSlab::getShared(TargetHandle handle) const {
+    return getSlot(handle).ts_target;
+}
+
+std::optional<TargetHandle> TargetSlab::find(unsigned int target_id) const {
+    auto it = this->sl_ids.find(target_id);
+    if (it == this->sl_ids.end()) {
+        return std::nullopt;
+    }
+    return TargetHandle{it->second, this->sl_slots[it->second].ts_generation};
+}
+
+std::size_t TargetSlab::size() const {
+    return this->sl_ids.size();
+}
@@ -0,0 +1,45 @@
+#ifndef ACE_ARTILLERY1_0_TARGETSLAB_H
+#define ACE_ARTILLERY1_0_TARGETSLAB_H
+
+#include "dependencies.h"
+#include "Gun.h"
+
+// stable reference to a target kept in a TargetSlab: slot index and the generation of the slot at the time of acquiring,
+// a handle of a released target does not match the slot any more even if the slot was reused for another target
+struct TargetHandle {
+    u_int32_t th_index;                                     // Slot of the target
+    u_int32_t th_generation;                                // Generation of the slot when the handle was issued
+    bool operator==(const TargetHandle&) const = default;
+};
+
+// targets bound to guns, each kept once however many guns it is bound to: pairs hold handles instead of own copies,
+// so a moved target is seen by all its pairs; slots of released targets are reused;
+// the slab belongs to the FireMissionStore and is guarded by the store lock together with the rows that refer to it,
+// target_map keeps its own copy of every target under its shard locks, so a bound target is held twice, not per pair
+class TargetSlab {
+private:
+    struct Slot {
+        std::shared_ptr<const Target> ts_target;            // Current copy of the target (null if the slot is free),
+                                                            // replaced on update, never changed, so it may be shared
+        u_int32_t ts_generation = 0;                        // Increased when the slot is released
+        u_int32_t ts_refs = 0;                              // Number of handles acquired and not released
+    };
+    std::vector<Slot> sl_slots;                             // Slots, addressed by TargetHandle::th_index
+    std::vector<u_int32_t> sl_free;                         // Free slots
+    std::unordered_map<unsigned int, u_int32_t> sl_ids;     // Target ID -> slot
+    [[nodiscard]] const Slot& getSlot(TargetHandle handle) const;
+public:
+    static bool isMoved(const Target& older, const Target& target);
+    static bool isChanged(const Target& older, const Target& target);
+    TargetHandle acquire(const Target& target);
+    void release(TargetHandle handle);
+    bool update(const Target& target);
+    void clear();
+    [[nodiscard]] bool isValid(TargetHandle handle) const;
+    [[nodiscard]] const Target& get(TargetHandle handle) const;
+    [[nodiscard]] const std::shared_ptr<const Target>& getShared(TargetHandle handle) const;
+    [[nodiscard]] std::optional<TargetHandle> find(unsigned int target_id) const;
+    [[nodiscard]] std::size_t size() const;
+};
+
+#endif //ACE_ARTILLERY1_0_TARGETSLAB_H
@@ -0,0 +1,164 @@
+#include "ThreadPool.h"
+
+// loop run by parallelFor(), alive on the stack of the calling thread until all its chunks are done
+struct ThreadPool::Job {
+    const std::function<void(std::size_t, std::size_t)>* j_body;    // Body called for each chunk
+    std::atomic<std::size_t> j_remaining;                            // Number of chunks not finished yet
+    std::mutex j_mutex;                                              // Guards j_error, j_error_begin and the last decrement
+    std::condition_variable j_done;                                  // Signalled when the last chunk is finished
+    std::exception_ptr j_error;                                      // Exception of the first chunk (by position) which failed
+    std::size_t j_error_begin;                                       // Position of the chunk which threw j_error
+};
+
+ThreadPool::ThreadPool(std::size_t threads) : tp_queued(0), tp_stop(false) {
+    // the calling thread takes part in every loop, so one thread less is started
+    std::size_t workers = threads > 1 ? threads - 1 : 0;
+    for (std::size_t i = 0; i <= workers; ++i) {
+        this->tp_queues.push_back(std::make_unique<Queue>());
+    }
+    for (std::size_t i = 0; i < workers; ++i) {
+        this->tp_workers.emplace_back(&ThreadPool::workerLoop, this, i + 1);
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(this->tp_mutex);
+        this->tp_stop = true;
+    }
+    this->tp_wakeup.notify_all();
+    for (auto &worker: this->tp_workers) {
+        worker.join();
+    }
+}
+
+std::size_t ThreadPool::size() const {
+    return this->tp_workers.size() + 1;
+}
+
+void ThreadPool::execute(const Chunk &chunk) {
+    Job &job = *chunk.ch_job;
+    try {
+        (*job.j_body)(chunk.ch_begin, chunk.ch_end);
+    } catch (...) {
+        // the exception of the earliest chunk is kept, so the same one is reported whatever the order of execution
+        std::lock_guard<std::mutex> lock(job.j_mutex);
+        if (!job.j_error || chunk.ch_begin < job.j_error_begin) {
+            job.j_error = std::current_exception();
+            job.j_error_begin = chunk.ch_begin;
+        }
+    }
+    // the count is decreased under the mutex: the caller only returns (destroying the job) after it has taken the
+    // mutex and seen no chunks remaining, so the job is not touched any more once the mutex is released here
+    std::lock_guard<std::mutex> lock(job.j_mutex);
+    if (job.j_remaining.fetch_sub(1) == 1) {
+        job.j_done.notify_all();
+    }
+}
+
+// runs one chunk from the queue of the thread, or one stolen from another queue, returns false if all queues are empty
+bool ThreadPool::runChunk(std::size_t index) {
+    Chunk chunk{};
+    bool found = false;
+    {
+        Queue &own = *this->tp_queues[index];
+        std::lock_guard<std::mutex> lock(own.q_mutex);
+        if (!own.q_chunks.empty()) {
+            chunk = own.q_chunks.back();
+            own.q_chunks.pop_back();
+            found = true;
+        }
+    }
+    for (std::size_t i = 1; !found && i < this->tp_queues.size(); ++i) {
+        Queue &other = *this->tp_queues[(index + i) % this->tp_queues.size()];
+        std::lock_guard<std::mutex> lock(other.q_mutex);
+        if (!other.q_chunks.empty()) {
+            chunk = other.q_chunks.front();
+            other.q_chunks.pop_front();
+            found = true;
+        }
+    }
+    if (!found) {
+        return false;
+    }
+    this->tp_queued.fetch_sub(1);
+    execute(chunk);
+    return true;
+}
+
+void ThreadPool::workerLoop(std::size_t index) {
+    while (true) {
+        if (runChunk(index)) {
+            continue;
+        }
+        std::unique_lock<std::mutex> lock(this->tp_mutex);
+        this->tp_wakeup.wait(lock, [this]() { return this->tp_stop || this->tp_queued.load() > 0; });
+        if (this->tp_stop) {
+            return;
+        }
+    }
+}
+
+// calls body(begin, end) for consecutive ranges of at most grain elements covering [0, count) and waits for all of them;
+// if some calls throw, the exception of the range with the smallest begin is rethrown after all ranges are finished
+void ThreadPool::parallelFor(std::size_t count, std::size_t grain,
+                             const std::function<void(std::size_t, std::size_t)> &body) {
+    if (count == 0) {
+        return;
+    }
+    grain = std::max<std::size_t>(grain, 1);
+    std::size_t chunks = (count + grain - 1) / grain;
+    if (chunks == 1 || this->tp_workers.empty()) {
+        body(0, count);
+        return;
+    }
+    Job job;
+    job.j_body = &body;
+    job.j_remaining = chunks;
+    job.j_error_begin = 0;
+    // chunks are counted before they are queued: a worker still busy in runChunk() may take one as soon as it is
+    // pushed, and its decrement must not come before the increment; the count is raised under the mutex, so that
+    // a worker checking it on the way to sleep can't miss the wakeup
+    {
+        std::lock_guard<std::mutex> lock(this->tp_mutex);
+        this->tp_queued.fetch_add(chunks);
+    }
+    // consecutive chunks are dealt to the queues in blocks, so that each worker starts on a contiguous part of the loop
+    std::size_t queues = this->tp_queues.size();
+    for (std::size_t q = 0; q < queues; ++q) {
+        std::size_t first = chunks * q / queues;
+        std::size_t last = chunks * (q + 1) / queues;
+        std::lock_guard<std::mutex> lock(this->tp_queues[q]->q_mutex);
+        for (std::size_t c = first; c < last; ++c) {
+            this->tp_queues[q]->q_chunks.push_back({&job, c * grain, std::min(count, (c + 1) * grain)});
+        }
+    }
+    this->tp_wakeup.notify_all();
+    while (job.j_remaining.load() > 0 && runChunk(0)) {
+    }
+    {
+        std::unique_lock<std::mutex> lock(job.j_mutex);
+        job.j_done.wait(lock, [&job]() { return job.j_remaining.load() == 0; });
+    }
+    if (job.j_error) {
+        std::rethrow_exception(job.j_error);
+    }
+}
+
+static std::mutex shared_pool_mutex;
+static std::unique_ptr<ThreadPool> shared_pool;
+
+ThreadPool &getThreadPool() {
+    std::lock_guard<std::mutex> lock(shared_pool_mutex);
+    if (!shared_pool) {
+        shared_pool = std::make_unique<ThreadPool>();
+    }
+    return *shared_pool;
+}
+
+void setThreadPoolSize(std::size_t threads) {
+    std::lock_guard<std::mutex> lock(shared_pool_mutex);
+    // workers of the previous pool are joined before the new ones are started
+    shared_pool.reset();
+    shared_pool = std::make_unique<ThreadPool>(threads);
+}
@@ -0,0 +1,50 @@
+#ifndef ACE_ARTILLERY1_0_THREADPOOL_H
+#define ACE_ARTILLERY1_0_THREADPOOL_H
+
+#include "dependencies.h"
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+// pool of worker threads for splitting loops over independent elements (e.g. rows of the fire mission store);
+// every worker has its own queue of chunks and takes chunks from the queues of other workers when its own is empty,
+// the calling thread works on the chunks too until the whole loop is done
+class ThreadPool {
+private:
+    struct Job;
+    struct Chunk {
+        Job* ch_job;                                        // Loop to which the chunk belongs
+        std::size_t ch_begin;                               // First element of the chunk
+        std::size_t ch_end;                                 // Element after the last one of the chunk
+    };
+    struct Queue {
+        std::mutex q_mutex;
+        std::deque<Chunk> q_chunks;
+    };
+    std::vector<std::unique_ptr<Queue>> tp_queues;          // Queue of each worker
+    std::vector<std::thread> tp_workers;                    // Worker threads
+    std::mutex tp_mutex;                                    // Guards sleeping of workers
+    std::condition_variable tp_wakeup;                      // Wakes workers up when chunks are queued or on shutdown
+    std::atomic<std::size_t> tp_queued;                     // Number of queued chunks, raised before the chunks are pushed
+    bool tp_stop;                                           // Set on destruction, guarded by tp_mutex
+    void workerLoop(std::size_t index);
+    bool runChunk(std::size_t index);
+    static void execute(const Chunk& chunk);
+public:
+    explicit ThreadPool(std::size_t threads = std::thread::hardware_concurrency());
+    ~ThreadPool();
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+    void parallelFor(std::size_t count, std::size_t grain, const std::function<void(std::size_t, std::size_t)>& body);
+    [[nodiscard]] std::size_t size() const;
+};
+
+// pool shared by the whole program, sized to the number of hardware threads, created on first use
+ThreadPool& getThreadPool();
+
+// replaces the shared pool by one with the given number of threads, e.g. to compare results and timings of loops
+// at different numbers of threads; must not be called while a loop runs on the shared pool
+void setThreadPoolSize(std::size_t threads);
+
+#endif //ACE_ARTILLERY1_0_THREADPOOL_H
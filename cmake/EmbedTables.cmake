@@ -0,0 +1,148 @@
+# Generates a header with ballistic and minimum distance tables as constexpr arrays.
+# Usage: cmake -DTABLES_DIR=<tables directory> -DOUTPUT=<generated header> -P EmbedTables.cmake
+#
+# Tables are listed in the same order as ballistic_table_names and distance_table_names in Data.cpp,
+# rows of every table are written in ascending order of distance. Ballistic rows are padded with zeros to
+# BALLISTIC_ROW_STRIDE (parameter count rounded up to SIMD_DOUBLE_WIDTH), the same layout as in BallisticTable.
+
+# must match SIMD_DOUBLE_WIDTH in InterpolationKernel.h
+set(SIMD_DOUBLE_WIDTH 4)
+
+set(BALLISTIC_TABLES
+        ballistic-table-d30-of462-full.csv
+        ballistic-table-d30-of462-full-mortar.csv
+        ballistic-table-d30-of462-reduced.csv
+        ballistic-table-d30-of462-reduced-mortar.csv
+        ballistic-table-d30-of462-1st.csv
+        ballistic-table-d30-of462-1st-mortar.csv
+        ballistic-table-d30-of462-2nd.csv
+        ballistic-table-d30-of462-2nd-mortar.csv
+        ballistic-table-d30-of462-3rd.csv
+        ballistic-table-d30-of462-3rd-mortar.csv
+        ballistic-table-d30-of462-4th.csv
+        ballistic-table-d30-of462-4th-mortar.csv)
+
+set(DISTANCE_TABLES
+        minimum-distance-d30-full.csv
+        minimum-distance-d30-reduced.csv
+        minimum-distance-d30-1st.csv
+        minimum-distance-d30-2nd.csv
+        minimum-distance-d30-3rd.csv
+        minimum-distance-d30-4th.csv)
+
+# reads a csv table and appends its distances and rows to the given variables, rows are padded with zeros to a multiple
+# of <align> parameters (1 for no padding), sets <prefix>_ROWS to the number of rows, <prefix>_COLUMNS to the number
+# of parameters per row and <prefix>_STRIDE to the number of values per padded row
+function(embed_table file prefix align distances rows)
+    file(STRINGS "${TABLES_DIR}/${file}" lines)
+    list(POP_FRONT lines header)
+    string(REPLACE "," ";" header "${header}")
+    list(LENGTH header columns)
+    math(EXPR columns "${columns} - 1")
+    math(EXPR stride "(${columns} + ${align} - 1) / ${align} * ${align}")
+    set(padding "")
+    foreach (i RANGE ${columns} ${stride})
+        if (i LESS stride)
+            string(APPEND padding ", 0")
+        endif ()
+    endforeach ()
+    list(GET lines 0 first_line)
+    list(GET lines -1 last_line)
+    string(REGEX MATCH "^[0-9]+" first_distance "${first_line}")
+    string(REGEX MATCH "^[0-9]+" last_distance "${last_line}")
+    if (first_distance GREATER last_distance)
+        list(REVERSE lines)
+    endif ()
+    set(table_distances "")
+    set(table_rows "")
+    set(row_count 0)
+    foreach (line IN LISTS lines)
+        string(STRIP "${line}" line)
+        if (line STREQUAL "")
+            continue()
+        endif ()
+        string(REPLACE "," ";" fields "${line}")
+        list(POP_FRONT fields distance)
+        list(LENGTH fields field_count)
+        if (NOT field_count EQUAL columns)
+            message(FATAL_ERROR "${file}: row for distance ${distance} has ${field_count} parameters instead of ${columns}")
+        endif ()
+        string(REPLACE ";" ", " fields "${fields}")
+        string(APPEND table_distances "${distance}, ")
+        string(APPEND table_rows "        ${fields}${padding},\n")
+        math(EXPR row_count "${row_count} + 1")
+    endforeach ()
+    set(${distances} "${${distances}}        ${table_distances}\n" PARENT_SCOPE)
+    set(${rows} "${${rows}}        // ${file}\n${table_rows}" PARENT_SCOPE)
+    set(${prefix}_ROWS ${row_count} PARENT_SCOPE)
+    set(${prefix}_COLUMNS ${columns} PARENT_SCOPE)
+    set(${prefix}_STRIDE ${stride} PARENT_SCOPE)
+endfunction()
+
+set(ballistic_distances "")
+set(ballistic_rows "")
+set(ballistic_offsets "0")
+set(ballistic_total 0)
+foreach (table IN LISTS BALLISTIC_TABLES)
+    embed_table(${table} TABLE ${SIMD_DOUBLE_WIDTH} ballistic_distances ballistic_rows)
+    math(EXPR ballistic_total "${ballistic_total} + ${TABLE_ROWS}")
+    string(APPEND ballistic_offsets ", ${ballistic_total}")
+    set(ballistic_columns ${TABLE_COLUMNS})
+    set(ballistic_stride ${TABLE_STRIDE})
+endforeach ()
+
+set(distance_keys "")
+set(distance_rows "")
+set(distance_offsets "0")
+set(distance_total 0)
+foreach (table IN LISTS DISTANCE_TABLES)
+    embed_table(${table} TABLE 1 distance_keys distance_rows)
+    math(EXPR distance_total "${distance_total} + ${TABLE_ROWS}")
+    string(APPEND distance_offsets ", ${distance_total}")
+    set(distance_columns ${TABLE_COLUMNS})
+endforeach ()
+
+list(LENGTH BALLISTIC_TABLES ballistic_count)
+list(LENGTH DISTANCE_TABLES distance_count)
+math(EXPR ballistic_offset_count "${ballistic_count} + 1")
+math(EXPR distance_offset_count "${distance_count} + 1")
+
+file(WRITE "${OUTPUT}.tmp"
+"// generated from the csv tables by cmake/EmbedTables.cmake, do not edit
+#ifndef ACE_ARTILLERY1_0_EMBEDDED_TABLES_DATA_H
+#define ACE_ARTILLERY1_0_EMBEDDED_TABLES_DATA_H
+
+#include <array>
+#include <cstddef>
+
+namespace embedded_tables {
+    inline constexpr std::size_t ballistic_columns = ${ballistic_columns};
+    inline constexpr std::size_t ballistic_stride = ${ballistic_stride};
+
+    // ballistic rows of i-th table are rows ballistic_offsets[i] to ballistic_offsets[i + 1] - 1
+    inline constexpr std::array<std::size_t, ${ballistic_offset_count}> ballistic_offsets = {${ballistic_offsets}};
+
+    inline constexpr std::array<int, ${ballistic_total}> ballistic_distances = {
+${ballistic_distances}    };
+
+    inline constexpr std::array<double, ${ballistic_total} * ballistic_stride> ballistic_rows = {
+${ballistic_rows}    };
+
+    inline constexpr std::size_t distance_columns = ${distance_columns};
+
+    // minimum distance rows of i-th table are rows distance_offsets[i] to distance_offsets[i + 1] - 1
+    inline constexpr std::array<std::size_t, ${distance_offset_count}> distance_offsets = {${distance_offsets}};
+
+    inline constexpr std::array<int, ${distance_total}> distance_keys = {
+${distance_keys}    };
+
+    inline constexpr std::array<double, ${distance_total} * distance_columns> distance_rows = {
+${distance_rows}    };
+}
+
+#endif
+")
+
+# the header is only replaced if it changed, so that unchanged tables do not trigger recompilation
+file(COPY_FILE "${OUTPUT}.tmp" "${OUTPUT}" ONLY_IF_DIFFERENT)
+file(REMOVE "${OUTPUT}.tmp")
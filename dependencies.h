@@ -20,6 +20,8 @@
 #include <memory>
 #include <deque>
 #include <algorithm>
+#include <limits>
+#include <numeric>
 #include "libs/rapidcsv.h"
 #include "libs/csv.h"
 #include "Mil.h"
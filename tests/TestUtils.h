@@ -0,0 +1,70 @@
+#ifndef ACE_ARTILLERY1_0_TESTUTILS_H
+#define ACE_ARTILLERY1_0_TESTUTILS_H
+
+#include "dependencies.h"
+#include "Gun.h"
+
+// variants of a SIMD kernel which the processor running the tests can execute, the scalar one first
+template<typename F>
+std::vector<std::pair<std::string, F>> getAvailableKernels(F scalar, F sse2, F avx2) {
+    std::vector<std::pair<std::string, F>> kernels{{"scalar", scalar}};
+#if defined(__x86_64__) || defined(__i386__)
+    __builtin_cpu_init();
+    kernels.emplace_back("sse2", sse2);
+    if (__builtin_cpu_supports("avx2")) {
+        kernels.emplace_back("avx2", avx2);
+    }
+#else
+    (void) sse2;
+    (void) avx2;
+#endif
+    return kernels;
+}
+
+// number of failed checks of a test, printed with the name of the check
+inline int reportCheck(const std::string& name, long failures, long total) {
+    std::cout << (failures ? "FAIL " : "ok   ") << name << ": " << failures << " of " << total << " differ\n";
+    return failures ? 1 : 0;
+}
+
+// guns of the fire mission tests stand within FIXTURE_GUN_SPREAD of the fixture point and their targets lie
+// FIXTURE_MIN_RANGE to FIXTURE_MAX_RANGE from it, so that no gun stands on a target
+constexpr double FIXTURE_X = 4500000.0;
+constexpr double FIXTURE_Y = 8500000.0;
+constexpr double FIXTURE_H = 2000.0;
+constexpr double FIXTURE_GUN_SPREAD = 2000.0;
+constexpr double FIXTURE_MIN_RANGE = 3000.0;
+constexpr double FIXTURE_MAX_RANGE = 12000.0;
+constexpr unsigned int FIXTURE_CHARGE_COUNT = 100;
+
+// guns at random points around the fixture point, directed at Mil(0) with reference points at 100, 200 and 300 Mil,
+// each with FIXTURE_CHARGE_COUNT charges of every type
+inline std::vector<Gun> makeGuns(std::mt19937_64& rng, int count) {
+    constexpr unsigned int n = FIXTURE_CHARGE_COUNT;
+    ChargeInventory charges{{lt_full, n}, {lt_reduced, n}, {lt_1st, n}, {lt_2nd, n}, {lt_3rd, n}, {lt_4th, n}};
+    std::uniform_real_distribution<double> spread(-FIXTURE_GUN_SPREAD, FIXTURE_GUN_SPREAD);
+    std::vector<Gun> guns;
+    guns.reserve(count);
+    for (int i = 0; i < count; ++i) {
+        double x = spread(rng), y = spread(rng);
+        guns.emplace_back(FIXTURE_X + x, FIXTURE_Y + y, FIXTURE_H, Mil(0), Mil(100), Mil(200), Mil(300));
+        guns.back().setCharges(charges);
+    }
+    return guns;
+}
+
+// targets at random points of the ring around the fixture point, up to 200 m above the fixture height
+inline std::vector<Target> makeTargets(std::mt19937_64& rng, int count) {
+    std::uniform_real_distribution<double> range(FIXTURE_MIN_RANGE, FIXTURE_MAX_RANGE);
+    std::uniform_real_distribution<double> angle(0, 2 * std::numbers::pi);
+    std::uniform_real_distribution<double> height(0, 200.0);
+    std::vector<Target> targets;
+    targets.reserve(count);
+    for (int i = 0; i < count; ++i) {
+        double r = range(rng), a = angle(rng), h = height(rng);
+        targets.emplace_back(FIXTURE_X + r * std::cos(a), FIXTURE_Y + r * std::sin(a), FIXTURE_H + h);
+    }
+    return targets;
+}
+
+#endif //ACE_ARTILLERY1_0_TESTUTILS_H
@@ -0,0 +1,49 @@
+#include "FireMissionStore.h"
+#include "TestUtils.h"
+#include "ThreadPool.h"
+#include <chrono>
+
+// time per gun-target pair of FireMissionStore::updateAll() at 1 to the given number of threads of the shared pool;
+// usage: fire_mission_bench [number of guns] [number of targets] [repetitions] [maximum number of threads]
+
+// nanoseconds per pair of the best of the repetitions
+template<typename F>
+static double timePerPair(F&& run, std::size_t pairs, int repetitions) {
+    double best = std::numeric_limits<double>::infinity();
+    for (int r = 0; r < repetitions; ++r) {
+        auto start = std::chrono::steady_clock::now();
+        run();
+        std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+        best = std::min(best, elapsed.count() / static_cast<double>(pairs));
+    }
+    return best;
+}
+
+int main(int argc, char** argv) {
+    int gun_count = argc > 1 ? std::stoi(argv[1]) : 2000;
+    int target_count = argc > 2 ? std::stoi(argv[2]) : 200;
+    int repetitions = argc > 3 ? std::stoi(argv[3]) : 5;
+    std::size_t max_threads = argc > 4 ? std::stoul(argv[4]) : std::max(1u, std::thread::hardware_concurrency());
+    readTableData();
+    std::mt19937_64 rng(5);
+    std::vector<Gun> guns = makeGuns(rng, gun_count);
+    std::vector<Target> targets = makeTargets(rng, target_count);
+    for (auto& gun: guns) {
+        for (auto& target: targets) {
+            gun_target_parameters.insert(gun, target, lt_full);
+        }
+    }
+    std::size_t pairs = gun_target_parameters.size();
+
+    std::cout << gun_count << " guns, " << target_count << " targets, best of " << repetitions
+              << " runs, ns per pair of updateAll()\n";
+    double single = 0;
+    for (std::size_t threads = 1; threads <= max_threads; ++threads) {
+        setThreadPoolSize(threads);
+        double ns = timePerPair([]() { gun_target_parameters.updateAll(); }, pairs, repetitions);
+        single = threads == 1 ? ns : single;
+        std::cout << std::left << std::setw(28) << std::to_string(threads) + " threads" << std::fixed
+                  << std::setprecision(2) << ns << "  (x" << single / ns << ")\n";
+    }
+    return 0;
+}
@@ -0,0 +1,166 @@
+#include "FireMissionStore.h"
+#include "TestUtils.h"
+#include <atomic>
+#include <thread>
+
+// guns and targets are changed, bound and dismissed by several threads while others read single pairs, snapshots and
+// the registries; the test is built with ThreadSanitizer where the compiler supports it, so that a data race on the
+// dirty flags, the shard locks or the registries fails it; afterwards the missions must be the ones of a full
+// recalculation and belong to the last versions of the guns and targets
+
+static constexpr int GUN_COUNT = 8;
+static constexpr int TARGET_COUNT = 48;
+static constexpr int MOVED_TARGET_COUNT = 32;               // Targets moved by the target thread, the rest are rebound
+static constexpr int GUN_THREAD_COUNT = 2;
+static constexpr int PAIR_READER_COUNT = 2;
+static constexpr int ITERATIONS = 200;
+
+static bool sameSolution(const FiringSolution& a, const FiringSolution& b) {
+    return a.fs_gun_id == b.fs_gun_id && a.fs_target_id == b.fs_target_id && a.fs_distance == b.fs_distance &&
+           a.fs_azimuth_abs == b.fs_azimuth_abs && a.fs_azimuth_main == b.fs_azimuth_main &&
+           a.fs_azimuth_res == b.fs_azimuth_res && a.fs_azimuth_night == b.fs_azimuth_night &&
+           a.fs_azimuth_turn == b.fs_azimuth_turn && a.fs_elevation == b.fs_elevation && a.fs_level == b.fs_level &&
+           a.fs_charge == b.fs_charge && a.fs_param_count == b.fs_param_count && a.fs_ballistic == b.fs_ballistic;
+}
+
+// solutions sorted and complete: every solution belongs to its gun and to a target of the snapshot
+static bool isConsistent(const FireMissionSnapshot& snapshot) {
+    std::size_t count = 0;
+    for (const auto& missions: snapshot.getGuns()) {
+        for (std::size_t i = 0; i < missions->gm_solutions.size(); ++i) {
+            const FiringSolution& solution = missions->gm_solutions[i];
+            if (solution.fs_gun_id != missions->gm_gun->getGunID() || !snapshot.findTarget(solution.fs_target_id) ||
+                (i > 0 && missions->gm_solutions[i - 1].fs_target_id >= solution.fs_target_id)) {
+                return false;
+            }
+        }
+        count += missions->gm_solutions.size();
+    }
+    return count == snapshot.size();
+}
+
+int main() {
+    readTableData();
+    std::mt19937_64 rng(20240611);
+    std::vector<Gun> guns = makeGuns(rng, GUN_COUNT);
+    std::vector<Target> targets = makeTargets(rng, TARGET_COUNT);
+    std::vector<unsigned int> gun_ids, target_ids;
+    for (const auto& gun: guns) {
+        gun_ids.push_back(gun.getGunID());
+        gun_map.insert(gun_ids.back(), gun);
+    }
+    for (auto& target: targets) {
+        target_ids.push_back(target.getTargetID());
+        target_map.insert(target_ids.back(), target);
+        for (auto& gun: guns) {
+            gun.addTarget(target);
+        }
+    }
+
+    std::atomic<long> errors = 0, reads = 0;
+    std::atomic<int> writers = GUN_THREAD_COUNT + 1;
+    std::vector<std::thread> threads;
+    // every gun thread changes its own guns and binds and dismisses the targets which are not moved
+    for (int t = 0; t < GUN_THREAD_COUNT; ++t) {
+        threads.emplace_back([&, t]() {
+            std::mt19937_64 local(t);
+            for (int it = 0; it < ITERATIONS; ++it) {
+                for (int i = t; i < GUN_COUNT; i += GUN_THREAD_COUNT) {
+                    Gun& gun = guns[i];
+                    gun.setAbsoluteDirection(Mil(static_cast<int>(local() % 6000)));
+                    gun.setDirection(Mil(static_cast<int>(local() % 6000)), Mil(200), Mil(300));
+                    if (it % 4 == 0) {
+                        gun.setGunH(2000.0 + it);
+                    }
+                    Target& target = targets[MOVED_TARGET_COUNT + local() % (TARGET_COUNT - MOVED_TARGET_COUNT)];
+                    if (gun_target_parameters.find(gun.getGunID(), target.getTargetID()) != FireMissionStore::npos) {
+                        gun.removeTarget(target);
+                    } else {
+                        gun.addTarget(target);
+                    }
+                    gun_map.assign(gun.getGunID(), gun);
+                }
+            }
+            --writers;
+        });
+    }
+    threads.emplace_back([&]() {
+        std::mt19937_64 local(GUN_THREAD_COUNT);
+        for (int it = 0; it < ITERATIONS; ++it) {
+            for (int n = 0; n < 8; ++n) {
+                Target& target = targets[local() % MOVED_TARGET_COUNT];
+                target.setTargetX(static_cast<int>(target.getTargetX()) + (it % 2 ? 50 : -50));
+                target_map.assign(target.getTargetID(), target);
+            }
+        }
+        --writers;
+    });
+    for (int t = 0; t < PAIR_READER_COUNT; ++t) {
+        threads.emplace_back([&, t]() {
+            std::mt19937_64 local(100 + t);
+            while (writers > 0) {
+                unsigned int gun_id = gun_ids[local() % GUN_COUNT], target_id = target_ids[local() % TARGET_COUNT];
+                try {
+                    auto params = gun_target_parameters.findParameters(gun_id, target_id);
+                    if (params && (params->getGunReference().getGunID() != gun_id ||
+                                   params->getTargetPointer()->getTargetID() != target_id)) {
+                        ++errors;
+                    }
+                } catch (const std::runtime_error&) {
+                    ++errors;
+                }
+                if (!gun_map.find(gun_id) || !target_map.contains(target_id)) {
+                    ++errors;
+                }
+                ++reads;
+            }
+        });
+    }
+    threads.emplace_back([&]() {
+        u_int64_t version = 0;
+        while (writers > 0) {
+            auto snapshot = gun_target_parameters.getSnapshot();
+            errors += !isConsistent(*snapshot) || snapshot->getVersion() < version;
+            version = snapshot->getVersion();
+            errors += gun_map.snapshot().size() != GUN_COUNT;
+            for (const auto& params: gun_target_parameters.getTargetParameters(target_ids[version % TARGET_COUNT])) {
+                errors += params.second.getGunReference().getGunID() != params.first;
+            }
+            ++reads;
+        }
+    });
+    for (auto& thread: threads) {
+        thread.join();
+    }
+    int failed = reportCheck("concurrent readers see consistent pairs and snapshots", errors, reads);
+
+    long stale = 0;
+    auto published = gun_target_parameters.getSnapshot();
+    gun_target_parameters.updateAll();
+    auto recalculated = gun_target_parameters.getSnapshot();
+    stale += !isConsistent(*published) || published->size() != recalculated->size();
+    for (const auto& missions: recalculated->getGuns()) {
+        for (const auto& solution: missions->gm_solutions) {
+            const FiringSolution* other = published->find(solution.fs_gun_id, solution.fs_target_id);
+            stale += !other || !sameSolution(*other, solution);
+        }
+    }
+    failed += reportCheck("missions after concurrent changes equal a full recalculation", stale,
+                          static_cast<long>(recalculated->size()));
+
+    long lost = 0;
+    for (const auto& gun: guns) {
+        const GunMissions* missions = published->findGun(gun.getGunID());
+        lost += !missions || missions->gm_gun->getDirectionAbs() != gun.getDirectionAbs() ||
+                missions->gm_gun->getGunH() != gun.getGunH() ||
+                missions->gm_solutions.size() != gun.getTargetNumber() ||
+                gun_map.find(gun.getGunID())->getDirectionMain() != gun.getDirectionMain();
+    }
+    for (const auto& target: targets) {
+        const Target* stored = published->findTarget(target.getTargetID());
+        lost += !stored || stored->getTargetX() != target.getTargetX() ||
+                target_map.find(target.getTargetID())->getTargetX() != target.getTargetX();
+    }
+    failed += reportCheck("last changes of guns and targets are kept", lost, GUN_COUNT + TARGET_COUNT);
+    return failed ? EXIT_FAILURE : EXIT_SUCCESS;
+}
@@ -0,0 +1,216 @@
+#include "FireMissionStore.h"
+#include "TestUtils.h"
+#include "ThreadPool.h"
+
+// updateAll() on the shared thread pool must give the same rows at any number of threads as recalculating them one
+// by one with updateRow() and as the standalone calculation of GunTargetParameters; parallelFor() must report the
+// error of the earliest failing range whatever the order the ranges ran in, and updateAll() and updateGun() must still
+// calculate the rows which don't fail; changes of a target which don't move it must not mark any row
+
+static constexpr int GUN_COUNT = 12;
+static constexpr int TARGET_COUNT = 100;
+static constexpr std::size_t THREAD_COUNTS[] = {1, 2, 3, 4, 8};
+static constexpr int FAILURE_RUNS = 200;
+
+static bool sameParameters(const GunTargetParameters& a, const GunTargetParameters& b) {
+    return a.getDistance() == b.getDistance() && a.getAzimuthAbs() == b.getAzimuthAbs() &&
+           a.getAzimuthMain() == b.getAzimuthMain() && a.getAzimuthRes() == b.getAzimuthRes() &&
+           a.getAzimuthNight() == b.getAzimuthNight() && a.getAzimuthTurn() == b.getAzimuthTurn() &&
+           a.getElevation() == b.getElevation() && a.getLevel() == b.getLevel() && a.getCharge() == b.getCharge() &&
+           a.getBallisticParameters() == b.getBallisticParameters();
+}
+
+static int checkUpdateAll(std::vector<Gun>& guns) {
+    long sequential_failures = 0, reference_failures = 0, total = 0;
+    std::mt19937_64 rng(17);
+    for (std::size_t threads: THREAD_COUNTS) {
+        // every run starts from other directions, so that the rows really change
+        setThreadPoolSize(1);
+        for (auto& gun: guns) {
+            gun.setAbsoluteDirection(Mil(static_cast<int>(rng() % 6000)));
+        }
+        std::vector<GunTargetParameters> sequential;
+        for (std::size_t row = 0; row < gun_target_parameters.size(); ++row) {
+            gun_target_parameters.updateRow(row);
+            sequential.push_back(gun_target_parameters.getParameters(row));
+        }
+        setThreadPoolSize(threads);
+        gun_target_parameters.updateAll();
+        for (std::size_t row = 0; row < gun_target_parameters.size(); ++row, ++total) {
+            GunTargetParameters parallel = gun_target_parameters.getParameters(row);
+            GunTargetParameters reference(parallel.getTargetPointer(), parallel.getGunReference(), parallel.getCharge());
+            sequential_failures += !sameParameters(parallel, sequential[row]) || gun_target_parameters.isDirty(row);
+            reference_failures += !sameParameters(parallel, reference);
+        }
+    }
+    int failed = reportCheck("updateAll() against updateRow() at 1 to 8 threads", sequential_failures, total);
+    failed += reportCheck("updateAll() against standalone GunTargetParameters", reference_failures, total);
+    return failed;
+}
+
+// elements fail at random positions, the error must always come from the failing range with the smallest begin among
+// the ranges the loop was split into, and every element of the other ranges must be visited exactly once
+static int checkParallelForErrors() {
+    long failures = 0;
+    std::mt19937_64 rng(23);
+    for (int run = 0; run < FAILURE_RUNS; ++run) {
+        ThreadPool pool(THREAD_COUNTS[run % std::size(THREAD_COUNTS)]);
+        std::size_t count = 1 + rng() % 5000, grain = 1 + rng() % 64;
+        std::set<std::size_t> failing;
+        for (int i = 0; i < 4; ++i) {
+            failing.insert(rng() % count);
+        }
+        std::vector<std::atomic<int>> visits(count);
+        std::mutex ranges_mutex;
+        std::vector<std::pair<std::size_t, std::size_t>> ranges;
+        std::string error;
+        try {
+            pool.parallelFor(count, grain, [&](std::size_t begin, std::size_t end) {
+                {
+                    std::lock_guard lock(ranges_mutex);
+                    ranges.emplace_back(begin, end);
+                }
+                auto fail = failing.lower_bound(begin);
+                if (fail != failing.end() && *fail < end) {
+                    throw std::runtime_error(std::to_string(begin));
+                }
+                for (std::size_t i = begin; i < end; ++i) {
+                    ++visits[i];
+                }
+            });
+        } catch (const std::runtime_error& e) {
+            error = e.what();
+        }
+        std::sort(ranges.begin(), ranges.end());
+        std::size_t covered = 0;
+        std::string expected;
+        for (const auto& [begin, end]: ranges) {
+            auto fail = failing.lower_bound(begin);
+            bool failed = fail != failing.end() && *fail < end;
+            if (failed && expected.empty()) {
+                expected = std::to_string(begin);
+            }
+            failures += begin != covered;
+            for (std::size_t i = begin; i < end; ++i) {
+                failures += visits[i] != (failed ? 0 : 1);
+            }
+            covered = end;
+        }
+        failures += covered != count || error != expected;
+    }
+    return reportCheck("parallelFor() reports the earliest failing range", failures, FAILURE_RUNS);
+}
+
+// a target moved next to a gun makes the rows of the guns close to it fail; updateAll() throws, leaves those rows marked
+// and calculates the others
+static int checkUpdateAllErrors(std::vector<Gun>& guns, std::vector<Target>& targets) {
+    long failures = 0;
+    Target& target = targets[TARGET_COUNT / 2];
+    double x = target.getTargetX(), y = target.getTargetY();
+    std::vector<charge_type> charges;
+    for (const auto& gun: guns) {
+        charges.push_back(gun_target_parameters.getCharge(gun_target_parameters.find(gun.getGunID(), target.getTargetID())));
+    }
+    target.setTargetX(static_cast<int>(guns[GUN_COUNT / 2].getGunX()) + 1);
+    target.setTargetY(static_cast<int>(guns[GUN_COUNT / 2].getGunY()));
+    std::set<std::size_t> failing;
+    auto moved = std::make_shared<const Target>(target);
+    for (std::size_t i = 0; i < guns.size(); ++i) {
+        const Gun& gun = guns[i];
+        try {
+            GunTargetParameters reference(moved, gun, charges[i]);
+        } catch (const std::runtime_error&) {
+            failing.insert(gun_target_parameters.find(gun.getGunID(), target.getTargetID()));
+        }
+    }
+    failures += failing.empty() || failing.size() == guns.size();
+    for (std::size_t threads: THREAD_COUNTS) {
+        setThreadPoolSize(threads);
+        try {
+            gun_target_parameters.updateAll();
+            ++failures;
+        } catch (const std::runtime_error&) {
+        }
+        for (std::size_t row = 0; row < gun_target_parameters.size(); ++row) {
+            failures += gun_target_parameters.isDirty(row) != failing.contains(row);
+        }
+    }
+    target.setTargetX(static_cast<int>(x));
+    target.setTargetY(static_cast<int>(y));
+    return reportCheck("updateAll() calculates the rows which don't fail", failures, std::size(THREAD_COUNTS));
+}
+
+// a target moved next to a gun fails only its own row of the gun; updateGun() throws, leaves that row marked and
+// calculates the other rows of the gun, also those in the same range as the failing one, and keeps the count of marks
+static int checkUpdateGunErrors(std::vector<Gun>& guns, std::vector<Target>& targets) {
+    long failures = 0;
+    Gun& gun = guns.front();
+    Target& target = targets.front();
+    double x = target.getTargetX(), y = target.getTargetY();
+    target.setTargetX(static_cast<int>(gun.getGunX()) + 1);
+    target.setTargetY(static_cast<int>(gun.getGunY()));
+    std::size_t failing = gun_target_parameters.find(gun.getGunID(), target.getTargetID());
+    std::mt19937_64 rng(29);
+    for (std::size_t threads: THREAD_COUNTS) {
+        setThreadPoolSize(threads);
+        gun.setAbsoluteDirection(Mil(static_cast<int>(rng() % 6000)));
+        try {
+            gun.updateTargetParameters();
+            ++failures;
+        } catch (const std::runtime_error&) {
+        }
+        for (std::size_t row: gun_target_parameters.getGunRows(gun.getGunID())) {
+            if (row == failing) {
+                failures += !gun_target_parameters.isDirty(row);
+                continue;
+            }
+            // checked before reading, which would calculate the row
+            failures += gun_target_parameters.isDirty(row);
+            GunTargetParameters updated = gun_target_parameters.getParameters(row);
+            GunTargetParameters reference(updated.getTargetPointer(), updated.getGunReference(), updated.getCharge());
+            failures += !sameParameters(updated, reference);
+        }
+        std::size_t marked = 0;
+        for (std::size_t row = 0; row < gun_target_parameters.size(); ++row) {
+            marked += gun_target_parameters.isDirty(row);
+        }
+        failures += marked != gun_target_parameters.countDirty();
+    }
+    target.setTargetX(static_cast<int>(x));
+    target.setTargetY(static_cast<int>(y));
+    return reportCheck("updateGun() calculates the rows which don't fail", failures, std::size(THREAD_COUNTS));
+}
+
+// a new name of a bound target is taken into the next snapshot without marking the rows of the guns bound to it
+static int checkTargetRename(std::vector<Target>& targets) {
+    Target& target = targets.back();
+    gun_target_parameters.flush();
+    std::string name = target.getTargetName();
+    target.setTargetName("renamed");
+    target.updateBoundGunParameters();
+    long failures = gun_target_parameters.countDirty() != 0;
+    const Target* published = gun_target_parameters.getSnapshot()->findTarget(target.getTargetID());
+    failures += !published || published->getTargetName() != "renamed";
+    target.setTargetName(name);
+    target.updateBoundGunParameters();
+    return reportCheck("updateTarget() marks no rows after a rename", failures, 1);
+}
+
+int main() {
+    readTableData();
+    std::mt19937_64 rng(11);
+    std::vector<Gun> guns = makeGuns(rng, GUN_COUNT);
+    std::vector<Target> targets = makeTargets(rng, TARGET_COUNT);
+    for (auto& target: targets) {
+        for (auto& gun: guns) {
+            gun.addTarget(target);
+        }
+    }
+    int failed = 0;
+    failed += checkUpdateAll(guns);
+    failed += checkParallelForErrors();
+    failed += checkUpdateAllErrors(guns, targets);
+    failed += checkUpdateGunErrors(guns, targets);
+    failed += checkTargetRename(targets);
+    return failed ? EXIT_FAILURE : EXIT_SUCCESS;
+}
@@ -0,0 +1,66 @@
+#include "Gun.h"
+#include "GeometryKernel.h"
+#include "TestUtils.h"
+#include <chrono>
+
+// time per target of every geometry kernel, of solveGeometryBatch() and of solveGeometry() called target by target;
+// usage: geometry_kernel_bench [number of targets] [repetitions]
+
+using GeometryKernelFunction = void (*)(double, double, double, const double*, const double*, const double*,
+                                        double*, double*, double*, std::size_t);
+
+// nanoseconds per target of the best of the repetitions
+template<typename F>
+static double timePerTarget(F&& run, std::size_t targets, int repetitions) {
+    double best = std::numeric_limits<double>::infinity();
+    for (int r = 0; r < repetitions; ++r) {
+        auto start = std::chrono::steady_clock::now();
+        run();
+        std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+        best = std::min(best, elapsed.count() / static_cast<double>(targets));
+    }
+    return best;
+}
+
+int main(int argc, char** argv) {
+    std::size_t n = argc > 1 ? std::stoul(argv[1]) : 1 << 18;
+    int repetitions = argc > 2 ? std::stoi(argv[2]) : 10;
+    std::mt19937_64 rng(7);
+    std::uniform_real_distribution<double> offset(-20000, 20000);
+    Gun gun(4500000, 8500000, 2000, Mil(1234), Mil(0), Mil(0), Mil(0));
+    std::vector<double> tg_x(n), tg_y(n), tg_h(n), distance(n), azimuth(n), level(n);
+    for (std::size_t i = 0; i < n; ++i) {
+        tg_x[i] = gun.getGunX() + offset(rng);
+        tg_y[i] = gun.getGunY() + offset(rng);
+        tg_h[i] = gun.getGunH() + offset(rng) / 30;
+    }
+
+    std::cout << n << " targets, best of " << repetitions << " runs, ns per target\n";
+    double checksum = 0;
+    auto kernels = getAvailableKernels<GeometryKernelFunction>(solveGeometryKernelScalar, solveGeometryKernelSSE2,
+                                                              solveGeometryKernelAVX2);
+    for (const auto& kernel: kernels) {
+        double ns = timePerTarget([&]() {
+            kernel.second(gun.getGunX(), gun.getGunY(), gun.getGunH(), tg_x.data(), tg_y.data(), tg_h.data(),
+                          distance.data(), azimuth.data(), level.data(), n);
+        }, n, repetitions);
+        checksum += azimuth[n / 2];
+        std::cout << std::left << std::setw(24) << "kernel " + kernel.first << std::fixed << std::setprecision(2) << ns << "\n";
+    }
+    GeometryBatch batch;
+    double batch_ns = timePerTarget([&]() { solveGeometryBatch(gun, tg_x, tg_y, tg_h, batch); }, n, repetitions);
+    checksum += batch.gb_azimuth[n / 2];
+    std::cout << std::left << std::setw(24) << "solveGeometryBatch()" << batch_ns << "\n";
+    double exact_ns = timePerTarget([&]() {
+        for (std::size_t i = 0; i < n; ++i) {
+            try {
+                checksum += solveGeometry(gun.getGunX(), gun.getGunY(), gun.getGunH(), gun.getDirectionAbs(),
+                                          tg_x[i], tg_y[i], tg_h[i]).ge_azimuth;
+            } catch (const std::runtime_error&) {
+            }
+        }
+    }, n, repetitions);
+    std::cout << std::left << std::setw(24) << "solveGeometry()" << exact_ns << "\n";
+    std::cout << "checksum " << std::setprecision(0) << checksum << "\n";
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,123 @@
+#include "Gun.h"
+#include "GeometryKernel.h"
+#include "TestUtils.h"
+#include <cstring>
+
+// the geometry kernels must give bit-identical results, distances equal to std::sqrt and angles within
+// GEOMETRY_KERNEL_ERROR of std::atan; solveGeometryBatch() must give exactly the results of solveGeometry()
+
+using GeometryKernelFunction = void (*)(double, double, double, const double*, const double*, const double*,
+                                        double*, double*, double*, std::size_t);
+
+static constexpr int GUN_COUNT = 20;
+static constexpr std::size_t TARGET_COUNT = 20003;   // not a multiple of the vector width, so that tails are checked
+
+// target offsets w.r.t. the gun mixing random directions with the hard cases: whole Mil angles, directions along
+// the axes, the diagonals and targets too close to the gun
+static void makeTargets(std::mt19937_64& rng, std::vector<double>& dx, std::vector<double>& dy, std::vector<double>& dh) {
+    std::uniform_real_distribution<double> offset(-20000, 20000), small(-1, 1);
+    dx.resize(TARGET_COUNT);
+    dy.resize(TARGET_COUNT);
+    dh.resize(TARGET_COUNT);
+    for (std::size_t i = 0; i < TARGET_COUNT; ++i) {
+        dx[i] = offset(rng);
+        dy[i] = offset(rng);
+        dh[i] = offset(rng) / 30;
+        if (i % 5 == 0) {
+            double angle = static_cast<double>(rng() % 6000) * std::numbers::pi / 3000;
+            double range = 50 + static_cast<double>(rng() % 20000);
+            dx[i] = range * std::cos(angle);
+            dy[i] = range * std::sin(angle);
+        } else if (i % 7 == 0) {
+            dx[i] = small(rng) * 1e-3;
+        } else if (i % 11 == 0) {
+            dy[i] = i % 2 ? 0. : small(rng) * 1e-3;
+        } else if (i % 13 == 0) {
+            dy[i] = i % 2 ? dx[i] : -dx[i];
+        } else if (i % 17 == 0) {
+            dx[i] = small(rng) * 14;
+            dy[i] = small(rng) * 14;
+        }
+    }
+}
+
+int main() {
+    std::mt19937_64 rng(2024);
+    auto kernels = getAvailableKernels<GeometryKernelFunction>(solveGeometryKernelScalar, solveGeometryKernelSSE2,
+                                                              solveGeometryKernelAVX2);
+    std::cout << "geometry kernels:";
+    for (const auto& kernel: kernels) {
+        std::cout << " " << kernel.first;
+    }
+    std::cout << ", dispatched: " << getGeometryKernelName() << "\n";
+
+    long identical_failures = 0, distance_failures = 0, angle_failures = 0, batch_failures = 0;
+    long kernel_total = 0, batch_total = 0;
+    double max_azimuth_error = 0, max_level_error = 0;
+    std::vector<double> dx, dy, dh, tg_x(TARGET_COUNT), tg_y(TARGET_COUNT), tg_h(TARGET_COUNT);
+    std::uniform_real_distribution<double> offset(-20000, 20000);
+    for (int g = 0; g < GUN_COUNT; ++g) {
+        Gun gun(4500000 + offset(rng), 8500000 + offset(rng), 2000 + offset(rng) / 50,
+                Mil(static_cast<int>(rng() % 6000)), Mil(0), Mil(0), Mil(0));
+        makeTargets(rng, dx, dy, dh);
+        for (std::size_t i = 0; i < TARGET_COUNT; ++i) {
+            tg_x[i] = gun.getGunX() + dx[i];
+            tg_y[i] = gun.getGunY() + dy[i];
+            tg_h[i] = gun.getGunH() + dh[i];
+        }
+
+        std::vector<std::vector<double>> distance, azimuth, level;
+        for (const auto& kernel: kernels) {
+            distance.emplace_back(TARGET_COUNT);
+            azimuth.emplace_back(TARGET_COUNT);
+            level.emplace_back(TARGET_COUNT);
+            kernel.second(gun.getGunX(), gun.getGunY(), gun.getGunH(), tg_x.data(), tg_y.data(), tg_h.data(),
+                          distance.back().data(), azimuth.back().data(), level.back().data(), TARGET_COUNT);
+        }
+        for (std::size_t i = 0; i < TARGET_COUNT; ++i) {
+            double dX = tg_x[i] - gun.getGunX();
+            double dY = tg_y[i] - gun.getGunY();
+            double dH = tg_h[i] - gun.getGunH();
+            if (dX * dX + dY * dY < 200) {
+                continue;       // results of targets too close to the gun are not defined
+            }
+            ++kernel_total;
+            for (std::size_t k = 1; k < kernels.size(); ++k) {
+                identical_failures += std::memcmp(&distance[0][i], &distance[k][i], sizeof(double)) != 0 ||
+                                      std::memcmp(&azimuth[0][i], &azimuth[k][i], sizeof(double)) != 0 ||
+                                      std::memcmp(&level[0][i], &level[k][i], sizeof(double)) != 0;
+            }
+            double exact_distance = std::sqrt(dX * dX + dY * dY);
+            distance_failures += distance[0][i] != exact_distance;
+            double azimuth_error = std::fabs(azimuth[0][i] - std::atan(dY / dX) * 3000 / std::numbers::pi);
+            double level_error = std::fabs(level[0][i] - std::atan(dH / exact_distance) * 3000 / std::numbers::pi);
+            max_azimuth_error = std::max(max_azimuth_error, azimuth_error);
+            max_level_error = std::max(max_level_error, level_error);
+            angle_failures += azimuth_error > GEOMETRY_KERNEL_ERROR || level_error > GEOMETRY_KERNEL_ERROR;
+        }
+
+        GeometryBatch batch;
+        solveGeometryBatch(gun, tg_x, tg_y, tg_h, batch);
+        for (std::size_t i = 0; i < TARGET_COUNT; ++i) {
+            ++batch_total;
+            try {
+                TargetGeometry exact = solveGeometry(gun.getGunX(), gun.getGunY(), gun.getGunH(), gun.getDirectionAbs(),
+                                                     tg_x[i], tg_y[i], tg_h[i]);
+                batch_failures += !batch.gb_valid[i] || exact.ge_distance != batch.gb_distance[i] ||
+                                  exact.ge_azimuth != batch.gb_azimuth[i] || exact.ge_turn != batch.gb_turn[i] ||
+                                  exact.ge_level != batch.gb_level[i];
+            } catch (const std::runtime_error&) {
+                batch_failures += batch.gb_valid[i] != 0;
+            }
+        }
+    }
+
+    std::cout << "largest angle error (Mil): azimuth " << max_azimuth_error << ", level " << max_level_error << "\n";
+    int failed = 0;
+    failed += reportCheck("kernels bit-identical to scalar", identical_failures,
+                          kernel_total * static_cast<long>(kernels.size() - 1));
+    failed += reportCheck("distance equal to std::sqrt", distance_failures, kernel_total);
+    failed += reportCheck("angles within GEOMETRY_KERNEL_ERROR of std::atan", angle_failures, kernel_total);
+    failed += reportCheck("solveGeometryBatch() equal to solveGeometry()", batch_failures, batch_total);
+    return failed ? EXIT_FAILURE : EXIT_SUCCESS;
+}
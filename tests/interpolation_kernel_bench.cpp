@@ -0,0 +1,76 @@
+#include "BallisticTable.h"
+#include "TestUtils.h"
+#include <chrono>
+
+// time per row of every interpolation kernel and of BallisticTable::getParameters() on sparse and dense tables;
+// usage: interpolation_kernel_bench [number of rows] [repetitions]
+
+using InterpolationKernelFunction = void (*)(const double*, const double*, int, int, int, double*, std::size_t);
+
+// nanoseconds per row of the best of the repetitions
+template<typename F>
+static double timePerRow(F&& run, std::size_t rows, int repetitions) {
+    double best = std::numeric_limits<double>::infinity();
+    for (int r = 0; r < repetitions; ++r) {
+        auto start = std::chrono::steady_clock::now();
+        run();
+        std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+        best = std::min(best, elapsed.count() / static_cast<double>(rows));
+    }
+    return best;
+}
+
+int main(int argc, char** argv) {
+    std::size_t n = argc > 1 ? std::stoul(argv[1]) : 1 << 18;
+    int repetitions = argc > 2 ? std::stoi(argv[2]) : 10;
+    std::mt19937_64 rng(7);
+    std::uniform_real_distribution<double> value(-1000, 1000);
+
+    // a synthetic table of 200 rows 100 m apart, as large as the real ones
+    BallisticTable table(BALLISTIC_PARAM_COUNT);
+    for (int i = 0; i < 200; ++i) {
+        std::vector<double> params(BALLISTIC_PARAM_COUNT);
+        std::generate(params.begin(), params.end(), [&]() { return value(rng); });
+        table.addRow(1000 + i * 100, params);
+    }
+    std::vector<int> distances(n);
+    std::uniform_int_distribution<int> distance(table.getMinDistance(), table.getMaxDistance());
+    std::generate(distances.begin(), distances.end(), [&]() { return distance(rng); });
+    std::vector<double> row(BallisticTable::stride);
+
+    std::cout << n << " rows of " << BALLISTIC_PARAM_COUNT << " parameters, best of " << repetitions
+              << " runs, ns per row\n";
+    double checksum = 0;
+    auto kernels = getAvailableKernels<InterpolationKernelFunction>(interpolateParametersScalar,
+                                                                   interpolateParametersSSE2,
+                                                                   interpolateParametersAVX2);
+    for (const auto& kernel: kernels) {
+        double ns = timePerRow([&]() {
+            for (std::size_t i = 0; i < n; ++i) {
+                std::size_t r = static_cast<std::size_t>(distances[i] - table.getMinDistance()) / 100;
+                r = std::min(r, table.size() - 2);
+                kernel.second(table.getRow(r), table.getRow(r + 1), table.getDistance(r), table.getDistance(r + 1),
+                              distances[i], row.data(), BallisticTable::stride);
+                checksum += row[0];
+            }
+        }, n, repetitions);
+        std::cout << std::left << std::setw(28) << "kernel " + kernel.first << std::fixed << std::setprecision(2) << ns << "\n";
+    }
+    double sparse_ns = timePerRow([&]() {
+        for (int d: distances) {
+            table.getParameters(d, row);
+            checksum += row[0];
+        }
+    }, n, repetitions);
+    std::cout << std::left << std::setw(28) << "getParameters() sparse" << sparse_ns << "\n";
+    table.densify();
+    double dense_ns = timePerRow([&]() {
+        for (int d: distances) {
+            table.getParameters(d, row);
+            checksum += row[0];
+        }
+    }, n, repetitions);
+    std::cout << std::left << std::setw(28) << "getParameters() dense" << dense_ns << "\n";
+    std::cout << "checksum " << std::setprecision(0) << checksum << "\n";
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,98 @@
+#include "BallisticTable.h"
+#include "EmbeddedTables.h"
+#include "TestUtils.h"
+#include <cstring>
+
+// the interpolation kernels must give results bit-identical to the scalar formula of the reference interpolation,
+// rows of the ballistic tables interpolated by the kernel must equal BallisticTable::getParameter() column by column
+
+using InterpolationKernelFunction = void (*)(const double*, const double*, int, int, int, double*, std::size_t);
+
+static constexpr int RANDOM_ROW_COUNT = 200000;
+static constexpr std::size_t MAX_ROW_LENGTH = 40;      // rows of every length up to it, so that all tails are checked
+
+// the formula the kernels implement, written out independently of interpolateParametersScalar()
+static double referenceInterpolation(double low, double high, int a, int b, int c) {
+    return (high - low) * (c - a) / (b - a) + low;
+}
+
+static bool sameBits(double x, double y) {
+    return std::memcmp(&x, &y, sizeof(double)) == 0;
+}
+
+// each kernel against the reference for random rows of mixed magnitudes and signs, at random distances between two rows
+static int checkRandomRows(const std::vector<std::pair<std::string, InterpolationKernelFunction>>& kernels) {
+    std::mt19937_64 rng(11);
+    std::uniform_real_distribution<double> value(-1, 1);
+    std::uniform_int_distribution<int> exponent(-8, 8), start(0, 30000), step(1, 500);
+    std::vector<double> low(MAX_ROW_LENGTH), high(MAX_ROW_LENGTH), out(MAX_ROW_LENGTH);
+    long failures = 0, total = 0;
+    for (int r = 0; r < RANDOM_ROW_COUNT; ++r) {
+        std::size_t n = static_cast<std::size_t>(r) % (MAX_ROW_LENGTH + 1);
+        for (std::size_t k = 0; k < n; ++k) {
+            low[k] = std::ldexp(value(rng), exponent(rng));
+            high[k] = r % 3 ? std::ldexp(value(rng), exponent(rng)) : low[k] + value(rng);
+        }
+        int a = start(rng);
+        int b = a + step(rng);
+        int c = a + static_cast<int>(rng() % static_cast<std::uint64_t>(b - a + 1));
+        for (const auto& kernel: kernels) {
+            std::fill(out.begin(), out.end(), std::numeric_limits<double>::quiet_NaN());
+            kernel.second(low.data(), high.data(), a, b, c, out.data(), n);
+            for (std::size_t k = 0; k < n; ++k, ++total) {
+                failures += !sameBits(out[k], referenceInterpolation(low[k], high[k], a, b, c));
+            }
+            // nothing may be written past the row
+            failures += std::any_of(out.begin() + static_cast<std::ptrdiff_t>(n), out.end(), [](double v) { return v == v; });
+        }
+    }
+    return reportCheck("kernels bit-identical to the reference on random rows", failures, total);
+}
+
+// rows of every meter of the compiled-in ballistic tables, sparse and dense, against the single-column reference
+static int checkBallisticTables() {
+#ifdef ACE_EMBED_TABLES
+    using namespace embedded_tables;
+    long failures = 0, total = 0;
+    std::vector<double> row(BallisticTable::stride);
+    for (std::size_t i = 0; i + 1 < ballistic_offsets.size(); ++i) {
+        std::span<const int> distances(ballistic_distances.data() + ballistic_offsets[i],
+                                       ballistic_offsets[i + 1] - ballistic_offsets[i]);
+        if (distances.empty()) {
+            continue;
+        }
+        BallisticTable sparse(ballistic_columns);
+        sparse.assignView(distances, std::span<const double>(ballistic_rows.data() + ballistic_offsets[i] * ballistic_stride,
+                                                             distances.size() * ballistic_stride));
+        BallisticTable dense = sparse;
+        dense.densify();
+        for (int distance = distances.front(); distance <= distances.back(); ++distance) {
+            for (const BallisticTable* table: {&sparse, &dense}) {
+                table->getParameters(distance, row);
+                for (std::size_t column = 0; column < ballistic_columns; ++column, ++total) {
+                    failures += !sameBits(row[column], sparse.getParameter(distance, static_cast<ballistic_param>(column)));
+                }
+            }
+        }
+    }
+    return reportCheck("ballistic table rows equal to BallisticTable::getParameter()", failures, total);
+#else
+    std::cout << "skip ballistic table rows: tables are not compiled in\n";
+    return 0;
+#endif
+}
+
+int main() {
+    auto kernels = getAvailableKernels<InterpolationKernelFunction>(interpolateParametersScalar,
+                                                                   interpolateParametersSSE2,
+                                                                   interpolateParametersAVX2);
+    std::cout << "interpolation kernels:";
+    for (const auto& kernel: kernels) {
+        std::cout << " " << kernel.first;
+    }
+    std::cout << ", dispatched: " << getInterpolationKernelName() << "\n";
+    int failed = 0;
+    failed += checkRandomRows(kernels);
+    failed += checkBallisticTables();
+    return failed ? EXIT_FAILURE : EXIT_SUCCESS;
+}
@@ -0,0 +1,76 @@
+#include "dependencies.h"
+#include "TestUtils.h"
+
+// Mil::sin(), Mil::cos() and atanMil() read compile-time tables, they must agree with libm for every whole Mil;
+// the one deliberate difference are covers exactly 45 degrees wide, see below
+
+// largest difference of the tables from std::sin and std::cos, the Taylor series behind them are exact to about 1 ulp
+static constexpr double MIL_TRIG_ERROR = 2e-15;
+
+static constexpr long RANDOM_RATIO_COUNT = 2000000;
+
+static int truncatedAtan(double ratio) {
+    return static_cast<int>(std::atan(ratio) * 3000 / std::numbers::pi);
+}
+
+int main() {
+    int failed = 0;
+
+    long trig_failures = 0;
+    double max_trig_error = 0;
+    for (int k = 0; k < 6000; ++k) {
+        Mil m(k);
+        double error = std::max(std::fabs(m.sin() - std::sin(m.toRadians())), std::fabs(m.cos() - std::cos(m.toRadians())));
+        max_trig_error = std::max(max_trig_error, error);
+        trig_failures += error > MIL_TRIG_ERROR;
+    }
+    std::cout << "largest sin/cos error " << max_trig_error << "\n";
+    failed += reportCheck("Mil::sin() and Mil::cos() of all 6000 Mil against std::sin and std::cos", trig_failures, 6000);
+
+    // tangents of whole Mil lie on the boundary between two results, where a rounding of either side decides,
+    // so there the neighbour below is accepted too; half a Mil away the result must be exactly the truncated atan
+    long whole_failures = 0, half_failures = 0, whole_total = 0;
+    for (int k = -1499; k < 1500; ++k) {
+        double ratio = std::tan(k * std::numbers::pi / 3000);
+        int mil = atanMil(ratio);
+        int expected = truncatedAtan(ratio);
+        whole_failures += mil != expected && std::abs(mil - expected) != 1;
+        double half_ratio = std::tan((k + 0.5) * std::numbers::pi / 3000);
+        half_failures += atanMil(half_ratio) != truncatedAtan(half_ratio);
+        ++whole_total;
+    }
+    failed += reportCheck("atanMil() of tangents of all whole Mil", whole_failures, whole_total);
+    failed += reportCheck("atanMil() of tangents of all half Mil", half_failures, whole_total);
+
+    std::mt19937_64 rng(5);
+    std::uniform_real_distribution<double> ratio_distribution(-3, 3);
+    long random_failures = 0;
+    for (long i = 0; i < RANDOM_RATIO_COUNT; ++i) {
+        double ratio = ratio_distribution(rng) * (i % 2 ? 1 : 100);
+        random_failures += atanMil(ratio) != truncatedAtan(ratio);
+    }
+    failed += reportCheck("atanMil() of random ratios", random_failures, RANDOM_RATIO_COUNT);
+
+    // the half-width angle of a cover used to be Mil(asin(w / 2 / side)), which gives 749 Mil for some covers of
+    // exactly 45 degrees (w = 2 * d) through rounding of libm; atanMil(w / 2 / d) gives the exact 750 Mil for all
+    // of them on purpose, every other cover keeps its angle
+    long cover_failures = 0, cover_total = 0, cover_changes = 0;
+    for (int w = 0; w <= 400; ++w) {
+        for (int d = 100; d <= 1000; ++d, ++cover_total) {
+            double side = std::sqrt(static_cast<double>(d) * d + w / 2. * (w / 2.));
+            int old_angle = Mil(std::asin(w / (2 * side))).toInt();
+            int new_angle = atanMil(w / 2. / d);
+            if (w == 2 * d) {
+                cover_failures += new_angle != 750 || (old_angle != 749 && old_angle != 750);
+                cover_changes += old_angle != new_angle;
+            } else {
+                cover_failures += old_angle != new_angle;
+            }
+        }
+    }
+    std::cout << "45 degree covers changed from 749 to 750 Mil: " << cover_changes << "\n";
+    failed += reportCheck("cover angles unchanged but 45 degrees (749 -> 750 Mil)", cover_failures, cover_total);
+    failed += reportCheck("atanMil(1) is 750 Mil", atanMil(1.) != 750, 1);
+
+    return failed ? EXIT_FAILURE : EXIT_SUCCESS;
+}
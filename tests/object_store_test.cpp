@@ -0,0 +1,325 @@
+#include "ObjectStore.h"
+#include "Process.h"
+#include "TableCache.h"
+#include "TestUtils.h"
+#include <csignal>
+#include <cstring>
+#include <sys/resource.h>
+
+// the object store must recover the last complete transaction from files cut off or damaged at any point, keep its
+// index across compaction and reopening, leave the file as it was when a commit fails, and saveData() / loadData()
+// must give back the same guns, targets and firing solutions
+
+struct RawRecord {
+    std::size_t rr_offset;                                  // Offset of the record header in the file
+    ObjectRecordHeader rr_header;
+};
+
+static std::vector<char> readFile(const std::string& path) {
+    std::ifstream in(path, std::ios::binary);
+    return {std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>()};
+}
+
+static void writeFile(const std::string& path, const std::vector<char>& bytes) {
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    out.write(bytes.data(), static_cast<std::streamsize>(bytes.size()));
+}
+
+// records of the file in the order they were written, read without any checks
+static std::vector<RawRecord> readRecords(const std::vector<char>& bytes) {
+    std::vector<RawRecord> records;
+    std::size_t offset = sizeof(ObjectStoreHeader);
+    while (offset + sizeof(ObjectRecordHeader) <= bytes.size()) {
+        RawRecord record{offset, {}};
+        std::memcpy(&record.rr_header, bytes.data() + offset, sizeof(ObjectRecordHeader));
+        records.push_back(record);
+        offset += sizeof(ObjectRecordHeader) + record.rr_header.or_size;
+    }
+    return records;
+}
+
+// writes the changed header of a record back into the file with a valid checksum, as ObjectStore does
+static void rewriteHeader(std::vector<char>& bytes, const RawRecord& record) {
+    ObjectRecordHeader header = record.rr_header;
+    header.or_checksum = 0;
+    const char* payload = bytes.data() + record.rr_offset + sizeof(ObjectRecordHeader);
+    header.or_checksum = fnv1aHash(payload, header.or_size, fnv1aHash(&header, sizeof(header)));
+    std::memcpy(bytes.data() + record.rr_offset, &header, sizeof(header));
+}
+
+// three transactions: guns 1 and 2; target 7 and erasure of gun 1; solution 9 and a new version of gun 2
+static void writeStore(const std::string& path) {
+    fs::remove(path);
+    ObjectStore store;
+    store.open(path);
+    ObjectTransaction transaction = store.begin();
+    transaction.put(ok_gun, 1, {{"name", "gun 1"}});
+    transaction.put(ok_gun, 2, {{"name", "gun 2"}});
+    store.commit(transaction);
+    transaction.put(ok_target, 7, {{"name", "target 7"}});
+    transaction.erase(ok_gun, 1);
+    store.commit(transaction);
+    transaction.put(ok_solution, 9, {{"charge", 3}});
+    transaction.put(ok_gun, 2, {{"name", "gun 2 moved"}});
+    store.commit(transaction);
+}
+
+// whether the store holds the state after all three transactions of writeStore(), or after the first two only
+static bool hasState(const ObjectStore& store, bool complete) {
+    auto gun = store.get(ok_gun, 2);
+    return store.getKeys(ok_gun) == std::vector<std::uint64_t>{2} && gun &&
+           (*gun)["name"] == (complete ? "gun 2 moved" : "gun 2") &&
+           store.getKeys(ok_target) == std::vector<std::uint64_t>{7} &&
+           store.getKeys(ok_solution) == (complete ? std::vector<std::uint64_t>{9} : std::vector<std::uint64_t>{});
+}
+
+// damages the file written by writeStore(), reopens it and checks that exactly the last transaction is dropped and cut
+// off, and that the store takes new transactions afterwards
+static long checkDamage(const std::string& path, const std::function<void(std::vector<char>&, const std::vector<RawRecord>&)>& damage) {
+    writeStore(path);
+    std::vector<char> bytes = readFile(path);
+    std::vector<RawRecord> records = readRecords(bytes);
+    std::size_t last_start = records[records.size() - 3].rr_offset;     // two puts and the commit record
+    damage(bytes, records);
+    writeFile(path, bytes);
+    long failures = 0;
+    ObjectStore store;
+    store.open(path);
+    failures += !hasState(store, false);
+    failures += store.getFileSize() != last_start || fs::file_size(path) != last_start;
+    ObjectTransaction transaction = store.begin();
+    transaction.put(ok_solution, 10, {{"charge", 4}});
+    store.commit(transaction);
+    store.close();
+    store.open(path);
+    failures += store.getKeys(ok_solution) != std::vector<std::uint64_t>{10};
+    return failures;
+}
+
+static int checkRecovery(const std::string& path) {
+    int failed = 0;
+    {
+        writeStore(path);
+        ObjectStore store;
+        store.open(path);
+        failed += reportCheck("reopened store holds all committed transactions", !hasState(store, true), 1);
+    }
+
+    long torn_failures = 0, torn_total = 0;
+    writeStore(path);
+    std::vector<char> complete = readFile(path);
+    std::vector<RawRecord> records = readRecords(complete);
+    std::size_t last_start = records[records.size() - 3].rr_offset;
+    // every cut within the last transaction, as left by a crash during its write
+    for (std::size_t size = last_start + 1; size < complete.size(); ++size, ++torn_total) {
+        torn_failures += checkDamage(path, [size](std::vector<char>& bytes, const std::vector<RawRecord>&) {
+            bytes.resize(size);
+        }) != 0;
+    }
+    failed += reportCheck("files cut off within the last transaction", torn_failures, torn_total);
+
+    failed += reportCheck("garbage after a torn write", checkDamage(path, [](std::vector<char>& bytes, const std::vector<RawRecord>& records) {
+        bytes.resize(records[records.size() - 2].rr_offset);
+        for (int i = 0; i < 100; ++i) {
+            bytes.push_back(static_cast<char>(i * 37));
+        }
+    }), 3);
+    failed += reportCheck("checksum mismatch of a payload", checkDamage(path, [](std::vector<char>& bytes, const std::vector<RawRecord>& records) {
+        bytes[records[records.size() - 2].rr_offset + sizeof(ObjectRecordHeader)] ^= 1;
+    }), 3);
+    failed += reportCheck("record magic mismatch", checkDamage(path, [](std::vector<char>& bytes, const std::vector<RawRecord>& records) {
+        RawRecord record = records[records.size() - 3];
+        record.rr_header.or_magic = ~OBJECT_RECORD_MAGIC;
+        rewriteHeader(bytes, record);
+    }), 3);
+    failed += reportCheck("commit record with a wrong record count", checkDamage(path, [](std::vector<char>& bytes, const std::vector<RawRecord>& records) {
+        RawRecord record = records.back();
+        ++record.rr_header.or_key;
+        rewriteHeader(bytes, record);
+    }), 3);
+    failed += reportCheck("records of different transactions before a commit", checkDamage(path, [](std::vector<char>& bytes, const std::vector<RawRecord>& records) {
+        RawRecord record = records[records.size() - 2];
+        ++record.rr_header.or_transaction;
+        rewriteHeader(bytes, record);
+    }), 3);
+
+    long header_failures = 0;
+    writeStore(path);
+    std::vector<char> bytes = readFile(path);
+    bytes[0] = 'X';
+    writeFile(path, bytes);
+    try {
+        ObjectStore store;
+        store.open(path);
+        ++header_failures;
+    } catch (const std::runtime_error&) {
+        header_failures += readFile(path) != bytes;         // a file of unknown format is left as it is
+    }
+    failed += reportCheck("store header magic mismatch refuses to open", header_failures, 1);
+    return failed;
+}
+
+static int checkCompaction(const std::string& path) {
+    fs::remove(path);
+    long failures = 0;
+    ObjectStore store;
+    store.open(path);
+    ObjectTransaction transaction = store.begin();
+    for (int version = 0; version < 50; ++version) {
+        for (std::uint64_t key = 0; key < 20; ++key) {
+            transaction.put(ok_target, key, {{"version", version}, {"key", key}});
+        }
+        transaction.erase(ok_gun, 1000 + version);
+        store.commit(transaction);
+    }
+    std::uint64_t before = store.getFileSize();
+    store.compact();
+    std::uint64_t after = store.getFileSize();
+    failures += after >= before || fs::file_size(path) != after || fs::exists(path + ".tmp");
+    auto check = [&failures](const ObjectStore& s) {
+        failures += s.size(ok_target) != 20;
+        for (std::uint64_t key = 0; key < 20; ++key) {
+            auto target = s.get(ok_target, key);
+            failures += !target || (*target)["version"] != 49 || (*target)["key"] != key;
+        }
+    };
+    check(store);
+    failures += store.size(ok_gun) != 0;
+    transaction.put(ok_gun, 5, {{"name", "after compaction"}});
+    store.commit(transaction);
+    store.close();
+    store.open(path);
+    check(store);
+    failures += store.getKeys(ok_gun) != std::vector<std::uint64_t>{5};
+
+    // overwriting the same objects over and over must not let the file grow without bound
+    std::string name(4000, 'x');
+    for (int version = 0; version < 2000; ++version) {
+        transaction.put(ok_gun, 5, {{"name", name}, {"version", version}});
+        store.commit(transaction);
+    }
+    failures += store.getFileSize() > 2 * OBJECT_STORE_COMPACTION_SIZE;
+    store.close();
+    store.open(path);
+    auto gun = store.get(ok_gun, 5);
+    failures += !gun || (*gun)["version"] != 1999 || store.size(ok_target) != 20;
+    return reportCheck("compaction keeps the current objects across reopening", failures != 0, 1);
+}
+
+// a write which fails half way (here: the file size limit) must leave the file and the index at the previous
+// transaction and keep the failed transaction for another try
+static int checkFailedCommit(const std::string& path) {
+    writeStore(path);
+    long failures = 0;
+    ObjectStore store;
+    store.open(path);
+    std::uint64_t size = store.getFileSize();
+    ObjectTransaction transaction = store.begin();
+    transaction.put(ok_gun, 3, {{"name", std::string(10000, 'g')}});
+    transaction.put(ok_target, 8, {{"name", "target 8"}});
+
+    std::signal(SIGXFSZ, SIG_IGN);
+    rlimit limit{};
+    getrlimit(RLIMIT_FSIZE, &limit);
+    rlimit lowered = limit;
+    lowered.rlim_cur = size + 1000;
+    setrlimit(RLIMIT_FSIZE, &lowered);
+    bool thrown = false;
+    try {
+        store.commit(transaction);
+    } catch (const std::runtime_error&) {
+        thrown = true;
+    }
+    setrlimit(RLIMIT_FSIZE, &limit);
+    failures += !thrown;
+    failures += fs::file_size(path) != size || store.getFileSize() != size;
+    failures += !hasState(store, true) || store.get(ok_gun, 3).has_value();
+    failures += transaction.size() != 2;
+
+    store.commit(transaction);
+    failures += !transaction.empty();
+    store.close();
+    store.open(path);
+    failures += !store.get(ok_gun, 3) || !store.get(ok_target, 8) || store.size(ok_gun) != 2;
+    return reportCheck("failed commit leaves the previous transaction", failures != 0, 1);
+}
+
+// guns and targets must come back with their IDs and data, solutions bound again, also those which can't be
+// calculated, and the next save must keep every key of the store
+static int checkSaveLoad(const std::string& directory) {
+    long failures = 0;
+    project_path = directory;
+    fs::create_directories(project_path);
+    readTableData();
+    std::mt19937_64 rng(3);
+    std::vector<Gun> guns = makeGuns(rng, 3);
+    for (std::size_t i = 0; i < guns.size(); ++i) {
+        guns[i].setAbsoluteDirection(Mil(100 + static_cast<int>(i)));
+        guns[i].setGunName("gun " + std::to_string(i));
+        guns[i].setGunDescription("test gun");
+        guns[i].setCovers({{Mil(2900), Mil(3100), 300, 20}});
+        gun_map.insert(guns[i].getGunID(), guns[i]);
+    }
+    std::vector<Target> targets = makeTargets(rng, 4);
+    for (std::size_t i = 0; i < targets.size(); ++i) {
+        targets[i].setTargetFront(200);
+        targets[i].setTargetDepth(100);
+        targets[i].setTargetName("target " + std::to_string(i));
+        target_map.insert(targets[i].getTargetID(), targets[i]);
+        for (auto& gun: guns) {
+            gun.addTarget(targets[i]);
+        }
+    }
+    // the first gun is moved onto the first target, the pair stays bound but can't be calculated
+    guns.front().setGunX(targets.front().getTargetX());
+    guns.front().setGunY(targets.front().getTargetY() + 1);
+    gun_map.assign(guns.front().getGunID(), guns.front());
+    saveData();
+    auto saved = gun_target_parameters.getSnapshot();
+    std::size_t stored = object_store.size(ok_gun) + object_store.size(ok_target) + object_store.size(ok_solution);
+
+    gun_map.clear();
+    target_map.clear();
+    gun_target_parameters.clear();
+    object_store.close();
+    loadData();
+    for (const auto& gun: guns) {
+        auto loaded = gun_map.find(gun.getGunID());
+        failures += !loaded || loaded->getGunName() != gun.getGunName() || loaded->getGunX() != gun.getGunX() ||
+                    loaded->getDirectionAbs() != gun.getDirectionAbs() || loaded->getCovers() != gun.getCovers() ||
+                    loaded->getCharges()[lt_2nd] != gun.getCharges()[lt_2nd];
+    }
+    for (const auto& target: targets) {
+        auto loaded = target_map.find(target.getTargetID());
+        failures += !loaded || loaded->getTargetName() != target.getTargetName() ||
+                    loaded->getTargetY() != target.getTargetY() || loaded->getTargetFront() != target.getTargetFront();
+    }
+    auto loaded = gun_target_parameters.getSnapshot();
+    failures += loaded->size() != saved->size() || saved->size() != guns.size() * targets.size() - 1;
+    failures += gun_target_parameters.getBindings().size() != guns.size() * targets.size();
+    for (const auto& missions: saved->getGuns()) {
+        for (const auto& solution: missions->gm_solutions) {
+            const FiringSolution* other = loaded->find(solution.fs_gun_id, solution.fs_target_id);
+            failures += !other || other->fs_distance != solution.fs_distance || other->fs_charge != solution.fs_charge ||
+                        other->fs_elevation != solution.fs_elevation || other->fs_azimuth_main != solution.fs_azimuth_main;
+        }
+    }
+    failures += generateUniqueID() <= targets.back().getTargetID();
+    saveData();
+    failures += object_store.size(ok_gun) + object_store.size(ok_target) + object_store.size(ok_solution) != stored;
+    object_store.close();
+    return reportCheck("saveData() and loadData() round trip", failures != 0, 1);
+}
+
+int main() {
+    fs::path directory = fs::temp_directory_path() / ("ace_object_store_test_" + std::to_string(getpid()));
+    fs::create_directories(directory);
+    std::string path = (directory / "test.store").string();
+    int failed = 0;
+    failed += checkRecovery(path);
+    failed += checkCompaction(path);
+    failed += checkFailedCommit(path);
+    failed += checkSaveLoad((directory / "project").string());
+    fs::remove_all(directory);
+    return failed ? EXIT_FAILURE : EXIT_SUCCESS;
+}